@@ -16,6 +16,8 @@ std::array<Magic, BOARD_SIZE> ROOK_TABLE;
 std::array<Magic, BOARD_SIZE> BISHOP_TABLE;
 std::array<uint64_t, 102400> ROOK_ATTACKS;
 std::array<uint64_t, 5248> BISHOP_ATTACKS;
+std::array<std::array<uint64_t, BOARD_SIZE>, BOARD_SIZE> BETWEEN_SQUARES;
+std::array<std::array<uint64_t, BOARD_SIZE>, BOARD_SIZE> LINE_SQUARES;
 
 // functions
 uint64_t rookAttacks(int square, uint64_t allPieces) {
@@ -26,9 +28,39 @@ uint64_t bishopAttacks(int square, uint64_t allPieces) {
     return BISHOP_ATTACKS[getMagicIndex(BISHOP_TABLE[square], allPieces)];
 }
 
+uint64_t betweenSquares(int square1, int square2) {
+    return BETWEEN_SQUARES[square1][square2];
+}
+
+uint64_t lineSquares(int square1, int square2) {
+    return LINE_SQUARES[square1][square2];
+}
+
 void init() {
     initMagicTable(ROOK_TABLE, ROOK_MAGICS, ROOK_ATTACKS, rookSlidingAttacks, false);
     initMagicTable(BISHOP_TABLE, BISHOP_MAGICS, BISHOP_ATTACKS, bishopSlidingAttacks, true);
+    initLineTables();
+}
+
+void initLineTables() {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            uint64_t square1 = 1ull << i, square2 = 1ull << j;
+            BETWEEN_SQUARES[i][j] = 0ull;
+            LINE_SQUARES[i][j] = 0ull;
+            if (i == j) {continue;}
+
+            // the attacks of two aligned pieces towards each other overlap in between them
+            if (rookSlidingAttacks(i, 0ull) & square2) {
+                BETWEEN_SQUARES[i][j] = rookSlidingAttacks(i, square2) & rookSlidingAttacks(j, square1);
+                LINE_SQUARES[i][j] = (rookSlidingAttacks(i, 0ull) & rookSlidingAttacks(j, 0ull)) | square1 | square2;
+            }
+            else if (bishopSlidingAttacks(i, 0ull) & square2) {
+                BETWEEN_SQUARES[i][j] = bishopSlidingAttacks(i, square2) & bishopSlidingAttacks(j, square1);
+                LINE_SQUARES[i][j] = (bishopSlidingAttacks(i, 0ull) & bishopSlidingAttacks(j, 0ull)) | square1 | square2;
+            }
+        }
+    }
 }
 
 template <typename Function, size_t SIZE>
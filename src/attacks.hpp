@@ -15,6 +15,8 @@ struct Magic {
 
 uint64_t rookAttacks(int square, uint64_t allPieces);
 uint64_t bishopAttacks(int square, uint64_t allPieces);
+uint64_t betweenSquares(int square1, int square2);
+uint64_t lineSquares(int square1, int square2);
 
 // internal initialization
 void init();
@@ -24,6 +26,7 @@ void initMagicTable(std::array<Magic, BOARD_SIZE>& table,
                     std::array<uint64_t, SIZE>& attackTable,
                     Function getAttackMask, bool isBishop);
 int getMagicIndex(Magic& entry, uint64_t blockers);
+void initLineTables();
 
 uint64_t getRelevantBlockerMask(int square, bool isBishop);
 std::vector<uint64_t> getPossibleBlockers(uint64_t slideMask);
@@ -36,6 +39,9 @@ extern std::array<Magic, BOARD_SIZE> ROOK_TABLE;
 extern std::array<Magic, BOARD_SIZE> BISHOP_TABLE;
 extern std::array<uint64_t, 102400> ROOK_ATTACKS;
 extern std::array<uint64_t, 5248> BISHOP_ATTACKS;
+// squares strictly between two aligned squares, and the full line through them; empty if they aren't aligned
+extern std::array<std::array<uint64_t, BOARD_SIZE>, BOARD_SIZE> BETWEEN_SQUARES;
+extern std::array<std::array<uint64_t, BOARD_SIZE>, BOARD_SIZE> LINE_SQUARES;
 
 // see ../tools/magic.cpp for how these magic numbers were generated
 constexpr std::array<uint64_t, BOARD_SIZE> ROOK_MAGICS{
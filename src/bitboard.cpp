@@ -79,6 +79,22 @@ uint64_t knightSquares(uint64_t knights) {
     return knightSquares;
 }
 
+uint64_t kingSquares(uint64_t kings) {
+    // prevent kings from teleporting to other side of the board with bit shifts
+    uint64_t sideways = ((kings >> 1) & NOT_FILE_H) | ((kings << 1) & NOT_FILE_A);
+    uint64_t row = kings | sideways;
+    
+    // up one row and down one row respectively
+    return sideways | (row >> 8) | (row << 8);
+}
+
+// white pawns attack towards rank 8 (lower squares), black pawns towards rank 1
+uint64_t pawnAttacks(uint64_t pawns, bool isWhite) {
+    uint64_t left  = pawns & NOT_FILE_A;
+    uint64_t right = pawns & NOT_FILE_H;
+    return isWhite ? (left >> 9) | (right >> 7) : (left << 7) | (right << 9);
+}
+
 bool pawnAttackers(int square, uint64_t enemyPawns, bool isWhiteTurn) {
     uint64_t currPiece = 1ull << square;
 
@@ -73,6 +73,8 @@ uint64_t getDiagMask(int square);
 uint64_t getAntiDiagMask(int square);
 
 uint64_t knightSquares(uint64_t knights);
+uint64_t kingSquares(uint64_t kings);
+uint64_t pawnAttacks(uint64_t pawns, bool isWhite);
 bool pawnAttackers(int square, uint64_t enemyPawns, bool isWhiteTurn);
 bool kingAttackers(int square, uint64_t enemyKings);
 
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <iostream>
@@ -29,6 +30,7 @@ Board::Board() {
     this->fiftyMoveRule = 0;
     this->pawnJumpedSquare = BoardSquare();
     this->isIllegalPos = false;
+    this->isInCheck = false;
     this->castlingRights = All_Castle;
     this->materialDifference = 0;
     this->eval = EvalAttributes();
@@ -97,6 +99,8 @@ Board::Board(std::array<pieceTypes, BOARD_SIZE> a_board, bool a_isWhiteTurn,
             this->pieceSets[BLACK_PIECES] |= makeBitboardFromArray(this->board, i);
         }
     }
+    // test positions don't always have both kings
+    this->isInCheck = this->pieceSets[this->isWhiteTurn ? WKing : BKing] && currKingInAttack(*this);
     this->initZobristKey();
 }
 
@@ -156,6 +160,7 @@ Board::Board(std::string fenStr) {
     this->fiftyMoveRule = stoi(token);
 
     this->isIllegalPos = false; // it is up to the UCI gui to not give illegal positions
+    this->isInCheck = this->pieceSets[this->isWhiteTurn ? WKing : BKing] && currKingInAttack(*this);
 
     this->initZobristKey();
     // Board doesn't use Fullmove counter
@@ -237,58 +242,106 @@ void Board::initZobristKey() {
     this->zobristKeyHistory = {this->zobristKey}; // synchronize history and current key
 }
 
+// Castle, en passant and promotion flags are inferred from the position, since UCI moves don't carry them
+// toMove will not check if the move is invalid
+Move Board::toMove(BoardMove move) const {
+    if (!move.isValid()) {
+        return Move();
+    }
+    pieceTypes allyKing = this->isWhiteTurn ? WKing : BKing;
+    pieceTypes allyPawn = this->isWhiteTurn ? WPawn : BPawn;
+    int promotionRank = this->isWhiteTurn ? 0 : 7;
+    int from = move.pos1.toSquare();
+    int to = move.pos2.toSquare();
+    pieceTypes originPiece = this->getPiece(from);
+
+    if (originPiece == allyKing && abs(move.pos2.file - move.pos1.file) == 2 &&
+        (this->castlingRights & castleRightsBit(move.pos2, this->isWhiteTurn))) {
+        return Move(from, to, CastleMove);
+    }
+    if (originPiece == allyPawn && move.pos2.rank == promotionRank) {
+        return Move(from, to, PromotionMove, toPromotionType(move.promotionPiece));
+    }
+    if (originPiece == allyPawn && move.pos2 == this->pawnJumpedSquare) {
+        return Move(from, to, EnPassantMove);
+    }
+    return Move(from, to);
+}
+
 // makeMove will not check if the move is invalid
 void Board::makeMove(BoardSquare pos1, BoardSquare pos2, pieceTypes promotionPiece) {
+    this->makeMove(this->toMove(BoardMove(pos1, pos2, promotionPiece)));
+}
+
+// makeMove will not check if the move is invalid
+void Board::makeMove(BoardMove move) {
+    this->makeMove(this->toMove(move));
+}
+
+// castling rights lost when a rook leaves or is captured on a square
+static castleRights rookSquareCastleRights(int square) {
+    switch (square) {
+        case 63: // h1
+            return NOT_W_OO;
+        case 56: // a1
+            return NOT_W_OOO;
+        case 7:  // h8
+            return NOT_B_OO;
+        case 0:  // a8
+            return NOT_B_OOO;
+        default:
+            return All_Castle;
+    }
+}
+
+// makeMove will not check if the move is invalid
+void Board::makeMove(Move move) {
     // allies haven't made a move yet
     pieceTypes allyKing = this->isWhiteTurn ? WKing : BKing;
     pieceTypes allyRook = this->isWhiteTurn ? WRook : BRook;
     pieceTypes allyPawn = this->isWhiteTurn ? WPawn : BPawn;
     pieceTypes enemyRook = this->isWhiteTurn ? BRook : WRook;
-    int pawnJumpDirection = this->isWhiteTurn ? -2 : 2;
-    int promotionRank = this->isWhiteTurn ? 0 : 7;
+    assert(this->pieceSets[allyKing]);
+    int from = move.from();
+    int to = move.to();
     
-    pieceTypes originPiece = this->getPiece(pos1);
-    pieceTypes targetPiece = this->getPiece(pos2);
+    pieceTypes originPiece = this->getPiece(from);
+    pieceTypes targetPiece = this->getPiece(to);
 
     this->moveHistory.push_back(BoardState(
-        BoardMove(pos1, pos2, promotionPiece),
+        move,
         originPiece,
         targetPiece,
         this->castlingRights,
         this->pawnJumpedSquare,
         this->fiftyMoveRule,
         this->materialDifference,
-        this->eval
+        this->eval,
+        this->isInCheck
     ));
 
     BoardSquare oldPawnJumpedSquare = this->pawnJumpedSquare;
     castleRights oldCastlingRights = this->castlingRights;
 
-    this->setPiece(pos1, EmptyPiece); // origin square should be cleared in all situations
-    this->setPiece(pos2, originPiece); // pretty much all possible moves translates the original piece to pos 2
+    this->setPiece(from, EmptyPiece); // origin square should be cleared in all situations
+    this->setPiece(to, originPiece); // pretty much all possible moves translates the original piece to the target
 
     // castling
     // doesn't check for emptiness between rook and king
-    if (originPiece == allyKing && (this->castlingRights & castleRightsBit(pos2, this->isWhiteTurn))) {
-        int kingFileDirection = pos2.file > pos1.file ? 1 : -1;
-        fileVals rookFile = kingFileDirection == 1 ? H : A;
-        this->setPiece(pos1.rank, pos1.file + kingFileDirection, allyRook);
-        this->setPiece(pos1.rank, rookFile, EmptyPiece);
+    if (move.flag() == CastleMove) {
+        int kingFileDirection = to > from ? 1 : -1;
+        int rookSquare = kingFileDirection == 1 ? from + 3 : from - 4;
+        this->setPiece(from + kingFileDirection, allyRook);
+        this->setPiece(rookSquare, EmptyPiece);
         this->castlingRights &= this->isWhiteTurn ? B_Castle : W_Castle;
     }
     else if (originPiece == allyKing) {
         this->castlingRights &= this->isWhiteTurn ? B_Castle : W_Castle;
     }
-    // jumping pawn
-    else if (originPiece == allyPawn && pos2.rank == pos1.rank + pawnJumpDirection) { 
-        // doesn't check if pawn's original position is rank 2
-        int behindDirection = this->isWhiteTurn ? 1 : -1;
-        this->pawnJumpedSquare = BoardSquare(pos2.rank + behindDirection, pos2.file);
-        this->zobristKey ^= Zobrist::enPassKeys[pos2.file];
-    }
     // promoting pawn
-    else if (originPiece == allyPawn && pos2.rank == promotionRank) {
-        this->setPiece(pos2, promotionPiece);
+    else if (move.flag() == PromotionMove) {
+        pieceTypes promotionPiece = move.promotionPiece(this->isWhiteTurn);
+        this->setPiece(to, promotionPiece);
 
         //updates material score of the board on promotion
         if(this->isWhiteTurn) {
@@ -300,8 +353,8 @@ void Board::makeMove(BoardSquare pos1, BoardSquare pos2, pieceTypes promotionPie
         this->eval.totalMaterial += abs(pieceValues[promotionPiece]) - 1;
     }
     // en passant 
-    else if (originPiece == allyPawn && pos2 == this->pawnJumpedSquare) {
-        this->setPiece(pos1.rank, pos2.file, EmptyPiece);
+    else if (move.flag() == EnPassantMove) {
+        this->setPiece(this->isWhiteTurn ? to + 8 : to - 8, EmptyPiece);
         this->pawnJumpedSquare = BoardSquare();
         this->eval.piecesRemaining--;
         this->eval.totalMaterial--;
@@ -314,6 +367,11 @@ void Board::makeMove(BoardSquare pos1, BoardSquare pos2, pieceTypes promotionPie
         else
             materialDifference--;
     }
+    // jumping pawn
+    else if (originPiece == allyPawn && abs(to - from) == 16) { 
+        this->pawnJumpedSquare = BoardSquare((from + to) / 2);
+        this->zobristKey ^= Zobrist::enPassKeys[to % 8];
+    }
 
     // reset fifty move rule on captures or pawn moves
     if (targetPiece != EmptyPiece || originPiece == allyPawn) {
@@ -325,16 +383,10 @@ void Board::makeMove(BoardSquare pos1, BoardSquare pos2, pieceTypes promotionPie
 
     // if either your allyRook is moved or an enemyRook is captured, modify castling rights
     if (originPiece == allyRook) {
-        this->castlingRights &= pos1 == BoardSquare("h1") ? NOT_W_OO  : All_Castle;
-        this->castlingRights &= pos1 == BoardSquare("a1") ? NOT_W_OOO : All_Castle;
-        this->castlingRights &= pos1 == BoardSquare("h8") ? NOT_B_OO  : All_Castle;
-        this->castlingRights &= pos1 == BoardSquare("a8") ? NOT_B_OOO : All_Castle;
+        this->castlingRights &= rookSquareCastleRights(from);
     }
     if (targetPiece == enemyRook) {
-        this->castlingRights &= pos2 == BoardSquare("h1") ? NOT_W_OO  : All_Castle;
-        this->castlingRights &= pos2 == BoardSquare("a1") ? NOT_W_OOO : All_Castle;
-        this->castlingRights &= pos2 == BoardSquare("h8") ? NOT_B_OO  : All_Castle;
-        this->castlingRights &= pos2 == BoardSquare("a8") ? NOT_B_OOO : All_Castle;
+        this->castlingRights &= rookSquareCastleRights(to);
     }
 
     // update zobrist key for changed castling rights; castling rights can only decrease in chess
@@ -372,48 +424,40 @@ void Board::makeMove(BoardSquare pos1, BoardSquare pos2, pieceTypes promotionPie
     if (oldPawnJumpedSquare != BoardSquare()) {
         this->zobristKey ^= Zobrist::enPassKeys[oldPawnJumpedSquare.file];
     }	
-    
-    // check for illegality 
-    this->isIllegalPos = currKingInAttack(*this);
 
     // after finalizing move logic, now switch turns
     this->isWhiteTurn = !this->isWhiteTurn; 
     this->zobristKey ^= Zobrist::isBlackKey;
+    this->isInCheck = this->pieceSets[this->isWhiteTurn ? WKing : BKing] && currKingInAttack(*this);
 
     // update history to include curr key
     this->zobristKeyHistory.push_back(this->zobristKey);
 }
 
-// makeMove will not check if the move is invalid
-void Board::makeMove(BoardMove move) {
-    this->makeMove(move.pos1, move.pos2, move.promotionPiece);
-}
-
-
 void Board::undoMove() {
     if (this->moveHistory.size() == 0) {
         return;
     }
     BoardState prev = moveHistory.back();
 
-    pieceTypes prevKing = this->isWhiteTurn ? BKing : WKing;
     pieceTypes prevRook = this->isWhiteTurn ? BRook : WRook;
-    pieceTypes prevPawn = this->isWhiteTurn ? BPawn : WPawn;
+    pieceTypes prevJumpedPawn = this->isWhiteTurn ? WPawn : BPawn;
+    int from = prev.move.from();
+    int to = prev.move.to();
 
-    this->setPiece(prev.move.pos1, prev.originPiece);
-    this->setPiece(prev.move.pos2, prev.targetPiece);
+    this->setPiece(from, prev.originPiece);
+    this->setPiece(to, prev.targetPiece);
 
     // castling
-    if (prev.originPiece == prevKing && (prev.castlingRights & castleRightsBit(prev.move.pos2, !this->isWhiteTurn)) ) {
-        int kingFileDirection = prev.move.pos2.file > prev.move.pos1.file ? 1 : -1;
-        fileVals rookFile = kingFileDirection == 1 ? H : A;
-        this->setPiece(prev.move.pos1.rank, prev.move.pos1.file + kingFileDirection, EmptyPiece);
-        this->setPiece(prev.move.pos1.rank, rookFile, prevRook);
+    if (prev.move.flag() == CastleMove) {
+        int kingFileDirection = to > from ? 1 : -1;
+        int rookSquare = kingFileDirection == 1 ? from + 3 : from - 4;
+        this->setPiece(from + kingFileDirection, EmptyPiece);
+        this->setPiece(rookSquare, prevRook);
     }
     // en passant
-    else if (prev.originPiece == prevPawn && prev.move.pos2 == prev.pawnJumpedSquare) {
-        pieceTypes prevJumpedPawn = prevPawn == BPawn ? WPawn : BPawn;
-        this->setPiece(prev.move.pos1.rank, prev.move.pos2.file, prevJumpedPawn);
+    else if (prev.move.flag() == EnPassantMove) {
+        this->setPiece(this->isWhiteTurn ? to - 8 : to + 8, prevJumpedPawn);
     }
 
     this->isWhiteTurn = !this->isWhiteTurn;
@@ -422,6 +466,7 @@ void Board::undoMove() {
     this->fiftyMoveRule = prev.fiftyMoveRule;
     this->materialDifference = prev.materialDifference;
     this->isIllegalPos = false;
+    this->isInCheck = prev.isInCheck;
     this->eval = prev.eval;
 
     this->moveHistory.pop_back();
@@ -429,6 +474,109 @@ void Board::undoMove() {
     this->zobristKey = zobristKeyHistory.back();
 }
 
+// Passes the turn, which is only used by search to prove that a position is good even without moving.
+// The fifty move counter is reset so that repetitions aren't detected across the null move.
+void Board::makeNullMove() {
+    this->moveHistory.push_back(BoardState(
+        Move(),
+        EmptyPiece,
+        EmptyPiece,
+        this->castlingRights,
+        this->pawnJumpedSquare,
+        this->fiftyMoveRule,
+        this->materialDifference,
+        this->eval,
+        this->isInCheck
+    ));
+
+    if (this->pawnJumpedSquare != BoardSquare()) {
+        this->zobristKey ^= Zobrist::enPassKeys[this->pawnJumpedSquare.file];
+        this->pawnJumpedSquare = BoardSquare();
+    }
+    this->fiftyMoveRule = 0;
+    this->isInCheck = false; // null moves are never made in check, so the opponent can't be in check either
+
+    this->isWhiteTurn = !this->isWhiteTurn;
+    this->zobristKey ^= Zobrist::isBlackKey;
+    this->zobristKeyHistory.push_back(this->zobristKey);
+}
+
+void Board::undoNullMove() {
+    BoardState prev = moveHistory.back();
+
+    this->isWhiteTurn = !this->isWhiteTurn;
+    this->pawnJumpedSquare = prev.pawnJumpedSquare;
+    this->fiftyMoveRule = prev.fiftyMoveRule;
+    this->isInCheck = prev.isInCheck;
+
+    this->moveHistory.pop_back();
+    this->zobristKeyHistory.pop_back();
+    this->zobristKey = zobristKeyHistory.back();
+}
+
+// Positions can only repeat since the last capture or pawn move, and only with the same side to move,
+// so only every other key since then is compared.
+// Positions within the last distanceFromRoot plies were reached by the search, and the side that
+// repeated them could have repeated them again, so a single repetition of those is a draw.
+bool Board::isRepetition(int distanceFromRoot) const {
+    int currIndex = this->zobristKeyHistory.size() - 1;
+    int reversiblePlies = std::min(this->fiftyMoveRule, currIndex);
+    int repetitions = 0;
+    for (int i = 4; i <= reversiblePlies; i += 2) {
+        if (this->zobristKeyHistory[currIndex - i] != this->zobristKey) {
+            continue;
+        }
+        repetitions++;
+        if (i < distanceFromRoot || repetitions == 2) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// without pieces other than pawns, zugzwang is common and passing the turn isn't a safe assumption
+bool Board::hasNonPawnMaterial() const {
+    int offset = this->isWhiteTurn ? 0 : BKing;
+    return this->pieceSets[WQueen + offset] | this->pieceSets[WBishop + offset] |
+           this->pieceSets[WKnight + offset] | this->pieceSets[WRook + offset];
+}
+
+// Whether move puts the opponent in check, from the attack tables on the position after it,
+// so that search can decide to prune a move without making it. Covers discovered checks,
+// promotions, en passant and the rook of a castling move.
+bool Board::givesCheck(Move move) const {
+    uint64_t enemyKing = this->pieceSets[this->isWhiteTurn ? BKing : WKing];
+    if (!enemyKing) { // test positions don't always have both kings
+        return false;
+    }
+    int kingSquare = leadingBit(enemyKing);
+    int from = move.from();
+    int to = move.to();
+    int offset = this->isWhiteTurn ? 0 : BKing;
+    pieceTypes movedPiece = move.flag() == PromotionMove ? move.promotionPiece(this->isWhiteTurn) : this->getPiece(from);
+
+    // allied pieces and occupancy once the move is made
+    std::array<uint64_t, BKing> allies;
+    std::copy(this->pieceSets.begin() + offset, this->pieceSets.begin() + offset + BKing, allies.begin());
+    allies[this->getPiece(from) - offset] ^= 1ull << from;
+    allies[movedPiece - offset] |= 1ull << to;
+    uint64_t occupied = ((this->pieceSets[WHITE_PIECES] | this->pieceSets[BLACK_PIECES]) & ~(1ull << from)) | 1ull << to;
+    if (move.flag() == EnPassantMove) {
+        occupied &= ~(1ull << (this->isWhiteTurn ? to + 8 : to - 8));
+    }
+    else if (move.flag() == CastleMove) {
+        int kingFileDirection = to > from ? 1 : -1;
+        uint64_t rookMove = 1ull << (kingFileDirection == 1 ? from + 3 : from - 4) | 1ull << (from + kingFileDirection);
+        allies[WRook] ^= rookMove;
+        occupied ^= rookMove;
+    }
+
+    return Attacks::bishopAttacks(kingSquare, occupied) & (allies[WBishop] | allies[WQueen])
+        || Attacks::rookAttacks(kingSquare, occupied) & (allies[WRook] | allies[WQueen])
+        || knightSquares(allies[WKnight]) & enemyKing
+        || pawnAttackers(kingSquare, allies[WPawn], !this->isWhiteTurn);
+}
+
 // getPiece is not responsible for bounds checking
 pieceTypes Board::getPiece(int rank, int file) const {
     return this->board[rank * 8 + file];
@@ -439,13 +587,23 @@ pieceTypes Board::getPiece(BoardSquare square) const{
     return this->getPiece(square.rank, square.file);
 }
 
-// handles board, pieceSets, and zobristKey (not including en passant and castling)
+// getPiece is not responsible for bounds checking
+pieceTypes Board::getPiece(int square) const {
+    return this->board[square];
+}
+
 void Board::setPiece(int rank, int file, pieceTypes currPiece) {
-    int square = rank * 8 + file;
+    this->setPiece(rank * 8 + file, currPiece);
+}
+
+// handles board, pieceSets, and zobristKey (not including en passant and castling)
+void Board::setPiece(int square, pieceTypes currPiece) {
+    int rank = square / 8;
+    int file = square % 8;
     uint64_t setSquare = (1ull << square);
     uint64_t clearSquare = ALL_SQUARES ^ setSquare;
 
-    pieceTypes originPiece = this->getPiece(rank, file);
+    pieceTypes originPiece = this->getPiece(square);
     this->board[square] = currPiece;
     
     if (originPiece != EmptyPiece) {
@@ -561,8 +719,9 @@ uint64_t makeBitboardFromArray(std::array<pieceTypes, BOARD_SIZE> board, int tar
 }
 
 bool Board::moveIsCapture(BoardMove move) {
-    if(this->getPiece(move.pos1) % 6 == WPawn && this->pawnJumpedSquare == move.pos2)
-        return true;
+    return this->moveIsCapture(this->toMove(move));
+}
 
-    return this->getPiece(move.pos2) != EmptyPiece;
+bool Board::moveIsCapture(Move move) const {
+    return move.flag() == EnPassantMove || this->getPiece(move.to()) != EmptyPiece;
 }
@@ -20,7 +20,7 @@ struct EvalAttributes {
 };
 
 struct BoardState {
-    BoardMove move = BoardMove();
+    Move move = Move();
     pieceTypes originPiece;
     pieceTypes targetPiece;
     castleRights castlingRights;
@@ -28,12 +28,13 @@ struct BoardState {
     int fiftyMoveRule;
     int materialDifference;
     EvalAttributes eval;
-    BoardState(BoardMove a_move, pieceTypes a_originPiece, pieceTypes a_targetPiece, 
+    bool isInCheck;
+    BoardState(Move a_move, pieceTypes a_originPiece, pieceTypes a_targetPiece, 
                 castleRights a_castlingRights, BoardSquare a_pawnJumpedSquare, int a_fiftyMoveRule,
-                int a_materialDifference, EvalAttributes a_eval) : 
+                int a_materialDifference, EvalAttributes a_eval, bool a_isInCheck) : 
                 move(a_move), originPiece(a_originPiece), targetPiece(a_targetPiece),
                 castlingRights(a_castlingRights), pawnJumpedSquare(a_pawnJumpedSquare), fiftyMoveRule(a_fiftyMoveRule),
-                materialDifference(a_materialDifference), eval(a_eval) {};
+                materialDifference(a_materialDifference), eval(a_eval), isInCheck(a_isInCheck) {};
 };
 
 struct Board {
@@ -47,10 +48,18 @@ struct Board {
     std::string toFen();
     void initZobristKey();
     
+    Move toMove(BoardMove move) const;
     void makeMove(BoardSquare pos1, BoardSquare pos2, pieceTypes promotionPiece = nullPiece);
     void makeMove(BoardMove move);
+    void makeMove(Move move);
     void undoMove();
+    void makeNullMove();
+    void undoNullMove();
     bool moveIsCapture(BoardMove move);
+    bool moveIsCapture(Move move) const;
+    bool isRepetition(int distanceFromRoot = 0) const;
+    bool hasNonPawnMaterial() const;
+    bool givesCheck(Move move) const;
     
     friend bool operator==(const Board& lhs, const Board& rhs);
     friend bool operator<(const Board& lhs, const Board& rhs);
@@ -58,7 +67,9 @@ struct Board {
 
     pieceTypes getPiece(int rank, int file) const;
     pieceTypes getPiece(BoardSquare square) const;
+    pieceTypes getPiece(int square) const;
     void setPiece(int rank, int file, pieceTypes currPiece);
+    void setPiece(int square, pieceTypes currPiece);
     void setPiece(BoardSquare square, pieceTypes currPiece);
     int getEvalScore() const;
 
@@ -69,7 +80,8 @@ struct Board {
     bool isWhiteTurn;
     castleRights castlingRights; // bitwise castling rights tracker
     int fiftyMoveRule;
-    bool isIllegalPos;
+    bool isIllegalPos; // only set by the debugging constructor, moves are generated legal so makeMove doesn't check
+    bool isInCheck; // the side to move is in check, so after makeMove it tells whether the move gave check
     BoardSquare pawnJumpedSquare; // en passant square
     int materialDifference; // updates on capture or promotion, so the eval doesn't have to calculate for each board, positive is white advantage
                             // Possibly could be combined with attributes
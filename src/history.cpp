@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "history.hpp"
+#include "board.hpp"
+#include "move.hpp"
+#include "types.hpp"
+
+History::History() {
+    this->clear();
+}
+
+void History::clear() {
+    for (auto& side: this->butterfly) {
+        for (auto& from: side) {
+            from.fill(0);
+        }
+    }
+    for (auto& piece: this->counterMoves) {
+        piece.fill(Move());
+    }
+    for (auto& previousPiece: this->continuation) {
+        for (auto& previousTo: previousPiece) {
+            for (auto& piece: previousTo) {
+                piece.fill(0);
+            }
+        }
+    }
+}
+
+// the butterfly score of the move plus how well it followed the previous move
+int History::getQuietScore(const Board& board, Move move) const {
+    int score = this->butterfly[board.isWhiteTurn][move.from()][move.to()];
+    if (!board.moveHistory.empty() && !board.moveHistory.back().move.isNull()) {
+        const BoardState& previous = board.moveHistory.back();
+        score += this->continuation[previous.originPiece][previous.move.to()][board.getPiece(move.from())][move.to()];
+    }
+    return score;
+}
+
+// null if there is no previous move, or it was never refuted by a quiet move
+Move History::getCounterMove(const Board& board) const {
+    if (board.moveHistory.empty() || board.moveHistory.back().move.isNull()) {
+        return Move();
+    }
+    const BoardState& previous = board.moveHistory.back();
+    return this->counterMoves[previous.originPiece][previous.move.to()];
+}
+
+// bestMove caused a beta cutoff, every other quiet move in quietsTried was searched before it and failed to
+void History::update(const Board& board, Move bestMove, const MoveList& quietsTried, int depth) {
+    int bonus = std::min(16 * depth * depth, MAX_HISTORY_BONUS);
+    bool hasPrevious = !board.moveHistory.empty() && !board.moveHistory.back().move.isNull();
+    pieceTypes previousPiece = hasPrevious ? board.moveHistory.back().originPiece : EmptyPiece;
+    int previousTo = hasPrevious ? board.moveHistory.back().move.to() : 0;
+
+    if (hasPrevious) {
+        this->counterMoves[previousPiece][previousTo] = bestMove;
+    }
+    for (const ScoredMove& tried: quietsTried) {
+        Move move = tried.move;
+        int moveBonus = move == bestMove ? bonus : -bonus;
+        this->applyBonus(this->butterfly[board.isWhiteTurn][move.from()][move.to()], moveBonus);
+        if (hasPrevious) {
+            this->applyBonus(this->continuation[previousPiece][previousTo][board.getPiece(move.from())][move.to()], moveBonus);
+        }
+    }
+}
+
+// Gravity: the closer an entry already is to the bound in the bonus' direction, the less it moves,
+// so scores stay bounded and recent results outweigh old ones.
+void History::applyBonus(int16_t& entry, int bonus) {
+    entry += bonus - entry * abs(bonus) / MAX_HISTORY;
+}
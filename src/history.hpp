@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "board.hpp"
+#include "move.hpp"
+#include "types.hpp"
+
+constexpr int MAX_HISTORY = 16384; // history scores stay within plus or minus this
+constexpr int MAX_HISTORY_BONUS = 1200;
+
+// Statistics about which quiet moves caused beta cutoffs, used to order quiet moves.
+// Every search thread keeps its own, since they are updated at every cutoff.
+class History {
+    public:
+        History();
+        void clear();
+        int getQuietScore(const Board& board, Move move) const;
+        Move getCounterMove(const Board& board) const;
+        void update(const Board& board, Move bestMove, const MoveList& quietsTried, int depth);
+
+    private:
+        static void applyBonus(int16_t& entry, int bonus);
+
+        std::array<std::array<std::array<int16_t, BOARD_SIZE>, BOARD_SIZE>, 2> butterfly; // [isWhiteTurn][from][to]
+        std::array<std::array<Move, BOARD_SIZE>, NUM_PIECE_TYPES> counterMoves; // best reply to [piece][to] of the previous move
+        // [piece][to] of the previous move, then [piece][to] of this move
+        std::array<std::array<std::array<std::array<int16_t, BOARD_SIZE>, NUM_PIECE_TYPES>, BOARD_SIZE>, NUM_PIECE_TYPES> continuation;
+};
@@ -1,11 +1,14 @@
 #include "uci.hpp"
 #include "attacks.hpp"
 #include "zobrist.hpp"
+#include "eval.hpp"
+#include "search.hpp"
 
 int main() {
     Zobrist::init();
     Attacks::init();
     Eval::init();
+    Search::init();
 
     if (!Uci::uci()) {return 1;}
     Uci::setOptionLoop();
@@ -20,7 +20,7 @@ BoardSquare::BoardSquare(int square) {
     this->file = fileVals(square % 8);
 }
 
-int BoardSquare::toSquare() {
+int BoardSquare::toSquare() const {
     return this->rank * 8 + this->file;
 }
 
@@ -77,6 +77,7 @@ BoardMove::BoardMove(std::string input, bool isWhiteTurn) {
     
     this->pos1 = BoardSquare(input.substr(0, 2));
     this->pos2 = BoardSquare(input.substr(2, 2));
+    this->promotionPiece = nullPiece;
 
     if (input.length() == 5) {
         switch (input.at(4)) {
@@ -145,5 +146,41 @@ bool operator<(const BoardMove& lhs, const BoardMove& rhs) {
     if (lhs.pos2 != rhs.pos2) {
         return lhs.pos2 < rhs.pos2;
     }
-    return false;
+    return lhs.promotionPiece < rhs.promotionPiece;
+}
+
+// Move
+
+std::string Move::toStr() const {
+    if (this->isNull()) {
+        return "0000"; // UCI representation of no move
+    }
+    std::ostringstream move;
+    move << BoardSquare(this->from()) << BoardSquare(this->to());
+    if (this->flag() == PromotionMove) {
+        std::array<char, 4> promotionRep = {'n', 'b', 'r', 'q'};
+        move << promotionRep.at((this->data >> 12) & 0x3);
+    }
+    return move.str();
+}
+
+std::ostream& operator<<(std::ostream& os, const Move& target) {
+    os << target.toStr();
+    return os;
+}
+
+promotionTypes toPromotionType(pieceTypes promotionPiece) {
+    switch (promotionPiece) {
+        case WKnight:
+        case BKnight:
+            return KnightPromotion;
+        case WBishop:
+        case BBishop:
+            return BishopPromotion;
+        case WRook:
+        case BRook:
+            return RookPromotion;
+        default:
+            return QueenPromotion;
+    }
 }
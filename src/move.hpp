@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <ostream>
 #include <string>
 
 #include "types.hpp"
@@ -11,7 +14,7 @@ struct BoardSquare {
     BoardSquare(std::string input);
     BoardSquare(int square); // from square
     std::string toStr();
-    int toSquare();
+    int toSquare() const;
     bool isValid() const;
 
     friend bool operator==(const BoardSquare& lhs, const BoardSquare& rhs);
@@ -35,4 +38,68 @@ struct BoardMove {
     friend std::ostream& operator<<(std::ostream& os, const BoardMove& target);
     friend bool operator==(const BoardMove& lhs, const BoardMove& rhs);
     friend bool operator<(const BoardMove& lhs, const BoardMove& rhs);
-};
\ No newline at end of file
+};
+
+enum moveFlags : uint16_t {
+    NormalMove    = 0 << 14,
+    PromotionMove = 1 << 14,
+    EnPassantMove = 2 << 14,
+    CastleMove    = 3 << 14,
+};
+
+enum promotionTypes : uint16_t {KnightPromotion, BishopPromotion, RookPromotion, QueenPromotion};
+
+constexpr std::array<std::array<pieceTypes, 4>, 2> PROMOTION_PIECES = {{
+    {{WKnight, WBishop, WRook, WQueen}},
+    {{BKnight, BBishop, BRook, BQueen}},
+}};
+
+// Moves used inside the engine are packed into 16 bits: origin square (6 bits), target square (6 bits),
+// promotion piece (2 bits) and a flag for moves that do more than move one piece (2 bits).
+// BoardMove is only used at the UCI boundary and in tests, Board::toMove converts it.
+struct Move {
+    constexpr Move(): data(0) {}; // a8a8 can never be played, so it is the null move
+    constexpr explicit Move(uint16_t a_data): data(a_data) {};
+    constexpr Move(int from, int to, moveFlags flag = NormalMove, promotionTypes promotion = KnightPromotion):
+        data(uint16_t(from | to << 6 | promotion << 12 | flag)) {};
+
+    int from() const {return this->data & 0x3F;};
+    int to() const {return (this->data >> 6) & 0x3F;};
+    moveFlags flag() const {return moveFlags(this->data & 0xC000);};
+    pieceTypes promotionPiece(bool isWhiteTurn) const {
+        return this->flag() == PromotionMove ? PROMOTION_PIECES[!isWhiteTurn][(this->data >> 12) & 0x3] : nullPiece;
+    };
+    bool isNull() const {return this->data == 0;};
+    std::string toStr() const;
+
+    friend bool operator==(const Move& lhs, const Move& rhs) {return lhs.data == rhs.data;};
+    friend bool operator!=(const Move& lhs, const Move& rhs) {return lhs.data != rhs.data;};
+    friend std::ostream& operator<<(std::ostream& os, const Move& target);
+    uint16_t data;
+};
+
+promotionTypes toPromotionType(pieceTypes promotionPiece);
+
+constexpr int MAX_MOVES = 256; // no legal position has more than 218 moves
+
+struct ScoredMove {
+    Move move;
+    int score;
+};
+
+// Fixed capacity list that lives on the stack, so generating and ordering moves never allocates.
+// Scores used for move ordering are kept next to their moves.
+struct MoveList {
+    void push_back(Move move) {
+        this->moves[this->count++].move = move;
+    };
+    size_t size() const {return this->count;};
+    ScoredMove& operator[](size_t index) {return this->moves[index];};
+    ScoredMove* begin() {return this->moves.data();};
+    ScoredMove* end() {return this->moves.data() + this->count;};
+    const ScoredMove* begin() const {return this->moves.data();};
+    const ScoredMove* end() const {return this->moves.data() + this->count;};
+
+    std::array<ScoredMove, MAX_MOVES> moves;
+    size_t count = 0;
+};
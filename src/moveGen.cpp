@@ -2,15 +2,64 @@
 #include "attacks.hpp"
 
 #include <cstdint>
-#include <vector>
 #include <stdexcept>
 #include <iostream>
 
 namespace MOVEGEN {
 
-    std::vector<BoardMove> moveGenerator(Board currBoard) {
-        std::vector<BoardMove> listOfMoves;
-        
+    LegalityInfo::LegalityInfo(const Board& currBoard) {
+        bool isWhite = currBoard.isWhiteTurn;
+        uint64_t allPieces = currBoard.pieceSets[WHITE_PIECES] | currBoard.pieceSets[BLACK_PIECES];
+        uint64_t allies = isWhite ? currBoard.pieceSets[WHITE_PIECES] : currBoard.pieceSets[BLACK_PIECES];
+        uint64_t enemies = isWhite ? currBoard.pieceSets[BLACK_PIECES] : currBoard.pieceSets[WHITE_PIECES];
+        uint64_t king = isWhite ? currBoard.pieceSets[WKing] : currBoard.pieceSets[BKing];
+
+        uint64_t enemyQueens  = isWhite ? currBoard.pieceSets[BQueen]  : currBoard.pieceSets[WQueen];
+        uint64_t enemyBishops = isWhite ? currBoard.pieceSets[BBishop] : currBoard.pieceSets[WBishop];
+        uint64_t enemyRooks   = isWhite ? currBoard.pieceSets[BRook]   : currBoard.pieceSets[WRook];
+        uint64_t enemyKnights = isWhite ? currBoard.pieceSets[BKnight] : currBoard.pieceSets[WKnight];
+        uint64_t enemyPawns   = isWhite ? currBoard.pieceSets[BPawn]   : currBoard.pieceSets[WPawn];
+        uint64_t enemyDiagonals = enemyBishops | enemyQueens;
+        uint64_t enemyStraights = enemyRooks | enemyQueens;
+
+        this->kingSquare = leadingBit(king);
+        this->checkers = (knightSquares(king) & enemyKnights)
+                       | (pawnAttacks(king, isWhite) & enemyPawns)
+                       | (Attacks::bishopAttacks(this->kingSquare, allPieces) & enemyDiagonals)
+                       | (Attacks::rookAttacks(this->kingSquare, allPieces) & enemyStraights);
+
+        // sliders that would attack the king if only enemy pieces blocked them
+        this->pinned = 0ull;
+        uint64_t snipers = (Attacks::bishopAttacks(this->kingSquare, enemies) & enemyDiagonals)
+                         | (Attacks::rookAttacks(this->kingSquare, enemies) & enemyStraights);
+        while (snipers) {
+            uint64_t blockers = Attacks::betweenSquares(this->kingSquare, popLeadingBit(snipers)) & allPieces;
+            if (popCount(blockers) == 1) {
+                this->pinned |= blockers & allies;
+            }
+        }
+
+        // a double check can only be escaped by moving the king
+        if (!this->checkers) {
+            this->checkMask = ALL_SQUARES;
+        }
+        else if (popCount(this->checkers) == 1) {
+            this->checkMask = this->checkers | Attacks::betweenSquares(this->kingSquare, leadingBit(this->checkers));
+        }
+        else {
+            this->checkMask = NO_SQUARES;
+        }
+
+        this->kingDanger = attackedSquares(currBoard, !isWhite, allPieces ^ king);
+    }
+
+    MoveList moveGenerator(const Board& currBoard) {
+        MoveList listOfMoves;
+        generateMoves(currBoard, LegalityInfo(currBoard), listOfMoves, AllMoves);
+        return listOfMoves;
+    }
+
+    void generateMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, genTypes type) {
         uint64_t kings   = currBoard.isWhiteTurn ? currBoard.pieceSets[WKing]   : currBoard.pieceSets[BKing]; 
         uint64_t pawns   = currBoard.isWhiteTurn ? currBoard.pieceSets[WPawn]   : currBoard.pieceSets[BPawn];
         uint64_t knights = currBoard.isWhiteTurn ? currBoard.pieceSets[WKnight] : currBoard.pieceSets[BKnight];
@@ -18,221 +67,254 @@ namespace MOVEGEN {
         uint64_t rooks   = currBoard.isWhiteTurn ? currBoard.pieceSets[WRook]   : currBoard.pieceSets[BRook];
         uint64_t queens  = currBoard.isWhiteTurn ? currBoard.pieceSets[WQueen]  : currBoard.pieceSets[BQueen];
 
-        validPawnMoves(currBoard, listOfMoves, pawns);
-        validKnightMoves(currBoard, listOfMoves, knights);
-        validBishopMoves(currBoard, listOfMoves, bishops);
-        validRookMoves(currBoard, listOfMoves, rooks);
-        validQueenMoves(currBoard, listOfMoves, queens);
-        validKingMoves(currBoard, listOfMoves, kings);
-        return listOfMoves;
+        // only the king can move out of a double check
+        if (info.checkMask) {
+            validPawnMoves(currBoard, info, validMoves, pawns, type);
+            validKnightMoves(currBoard, info, validMoves, knights, type);
+            validBishopMoves(currBoard, info, validMoves, bishops, type);
+            validRookMoves(currBoard, info, validMoves, rooks, type);
+            validQueenMoves(currBoard, info, validMoves, queens, type);
+        }
+        validKingMoves(currBoard, info, validMoves, kings, type);
     }
 
-    void validPawnMoves(Board& currBoard, std::vector<BoardMove>& validMoves, uint64_t pawns) {
-        int promoteRank = currBoard.isWhiteTurn ? 0 : 7;
-        pieceTypes allyKnight = currBoard.isWhiteTurn ? WKnight : BKnight;
-        pieceTypes allyBishop = currBoard.isWhiteTurn ? WBishop : BBishop;
-        pieceTypes allyRook = currBoard.isWhiteTurn ? WRook : BRook;
-        pieceTypes allyQueen = currBoard.isWhiteTurn ? WQueen : BQueen;
+    void validPawnMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, uint64_t pawns, genTypes type) {
+        bool isWhite = currBoard.isWhiteTurn;
+        int promoteRank = isWhite ? 0 : 7;
+        int originRank = isWhite ? 6 : 1;
+        int pawnDirection = isWhite ? -8 : 8;
+        uint64_t allPieces = currBoard.pieceSets[WHITE_PIECES] | currBoard.pieceSets[BLACK_PIECES];
+        uint64_t enemies = isWhite ? currBoard.pieceSets[BLACK_PIECES] : currBoard.pieceSets[WHITE_PIECES];
+        uint64_t enPassant = currBoard.pawnJumpedSquare.isValid() && (type & NoisyMoves) ? 1ull << currBoard.pawnJumpedSquare.toSquare() : 0ull;
+        // pushes onto the last rank are promotions, so they count as noisy
+        uint64_t noisySquares = enemies | getRankMask(promoteRank * 8);
 
         while (pawns) {
-            BoardSquare pawn(popLeadingBit(pawns));
-            std::vector<BoardSquare> pawnMoves;
+            int square = popLeadingBit(pawns);
+            uint64_t pawnBitboard = 1ull << square;
+            uint64_t captures = pawnAttacks(pawnBitboard, isWhite);
+            uint64_t pawnMoves = captures & enemies;
 
-            forwardPawnMoves(currBoard, pawnMoves, pawn);
-            pawnCaptures(currBoard, pawnMoves, pawn, 1);
-            pawnCaptures(currBoard, pawnMoves, pawn, -1);        
-        
-            for (BoardSquare move: pawnMoves) {
-                currBoard.makeMove(pawn, move, allyKnight); // promotion piece is a placeholder
-                if (currBoard.isIllegalPos) {
-                    currBoard.undoMove();
-                    continue;
-                }
-                if (move.rank == promoteRank) {
-                    validMoves.push_back(BoardMove(pawn, move, allyKnight));
-                    validMoves.push_back(BoardMove(pawn, move, allyBishop));
-                    validMoves.push_back(BoardMove(pawn, move, allyRook));
-                    validMoves.push_back(BoardMove(pawn, move, allyQueen));
-                }
-                else {
-                    validMoves.push_back(BoardMove(pawn, move));
+            // any spaces forward
+            int forward = square + pawnDirection;
+            if (!(allPieces & 1ull << forward)) {
+                pawnMoves |= 1ull << forward;
+                // jump
+                if (getRank(square) == originRank && !(allPieces & 1ull << (forward + pawnDirection))) {
+                    pawnMoves |= 1ull << (forward + pawnDirection);
                 }
-                currBoard.undoMove();
             }
-        }
-    }
-
-
-    void forwardPawnMoves(Board& currBoard, std::vector<BoardSquare>& pawnMoves, BoardSquare pawn) {
-        int pawnDirection = currBoard.isWhiteTurn ? -1 : 1;
-        int originRank = currBoard.isWhiteTurn ? 6 : 1;
 
-        // any spaces forward
-        if (currBoard.getPiece(pawn.rank + pawnDirection, pawn.file) == EmptyPiece) {
-            pawnMoves.push_back(BoardSquare(pawn.rank + pawnDirection, pawn.file));
-            // jump
-            if (pawn.rank == originRank) {
-                if (currBoard.getPiece(pawn.rank + pawnDirection * 2, pawn.file) == EmptyPiece) {
-                    pawnMoves.push_back(BoardSquare(pawn.rank + pawnDirection * 2, pawn.file));
+            pawnMoves &= info.checkMask;
+            if (!(type & NoisyMoves)) {
+                pawnMoves &= ~noisySquares;
+            }
+            if (!(type & QuietMoves)) {
+                pawnMoves &= noisySquares;
+            }
+            if (info.pinned & pawnBitboard) {
+                pawnMoves &= Attacks::lineSquares(info.kingSquare, square);
             }
-        }
-        }
-    }
 
-    void pawnCaptures(Board& currBoard, std::vector<BoardSquare>& pawnMoves, BoardSquare pawn, int fileDirection) {
-        int pawnDirection = currBoard.isWhiteTurn ? -1 : 1;
+            // en passant removes two pieces from the same rank, so it is checked on its own
+            if ((captures & enPassant) && enPassantIsLegal(currBoard, info, square)) {
+                validMoves.push_back(Move(square, currBoard.pawnJumpedSquare.toSquare(), EnPassantMove));
+            }
 
-        BoardSquare square = BoardSquare(pawn.rank + pawnDirection, pawn.file + fileDirection);
-        // regular capture
-        if (square.isValid() && !isFriendlyPiece(currBoard, square) && currBoard.getPiece(square) != EmptyPiece) {
-            pawnMoves.push_back(square);
-        }
-        // en passant
-        if (square == currBoard.pawnJumpedSquare) {
-            pawnMoves.push_back(square);
+            while (pawnMoves) {
+                int target = popLeadingBit(pawnMoves);
+                if (getRank(target) == promoteRank) {
+                    validMoves.push_back(Move(square, target, PromotionMove, QueenPromotion));
+                    if (!(type & NoUnderpromotions)) {
+                        validMoves.push_back(Move(square, target, PromotionMove, KnightPromotion));
+                        validMoves.push_back(Move(square, target, PromotionMove, BishopPromotion));
+                        validMoves.push_back(Move(square, target, PromotionMove, RookPromotion));
+                    }
+                }
+                else {
+                    validMoves.push_back(Move(square, target));
+                }
+            }
         }
     }
 
-    void validKnightMoves(Board& currBoard, std::vector<BoardMove>& validMoves, uint64_t knights) {
-        uint64_t allies = currBoard.isWhiteTurn ? currBoard.pieceSets[WHITE_PIECES] : currBoard.pieceSets[BLACK_PIECES];
+    void validKnightMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, uint64_t knights, genTypes type) {
+        uint64_t targets = moveTargets(currBoard, type);
+        // a pinned knight can never stay on the pinning line
+        knights &= ~info.pinned;
         while (knights) {
             int square = popLeadingBit(knights);
-            BoardSquare knight(square);
             uint64_t knightBitboard = 1ull << square;
-            uint64_t knightMoves = knightSquares(knightBitboard) & ~allies;
+            uint64_t knightMoves = knightSquares(knightBitboard) & targets & info.checkMask;
             while (knightMoves) {
-                int currSquare = popLeadingBit(knightMoves);
-                BoardSquare move(currSquare);
-                currBoard.makeMove(knight, move);
-                if (!currBoard.isIllegalPos) {
-                    validMoves.push_back(BoardMove(knight, move));
-                }
-                currBoard.undoMove();
+                validMoves.push_back(Move(square, popLeadingBit(knightMoves)));
             }
 
         }
     }
 
-    void validBishopMoves(Board& currBoard, std::vector<BoardMove>& validMoves, uint64_t bishops) {
+    void validBishopMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, uint64_t bishops, genTypes type) {
         uint64_t allPieces = currBoard.pieceSets[WHITE_PIECES] | currBoard.pieceSets[BLACK_PIECES];
-        uint64_t friendlyPieces = currBoard.isWhiteTurn ? currBoard.pieceSets[WHITE_PIECES] : currBoard.pieceSets[BLACK_PIECES];
+        uint64_t targets = moveTargets(currBoard, type);
         while (bishops) {
             int square = popLeadingBit(bishops);
-            BoardSquare bishop(square);
-            uint64_t bishopMoves = Attacks::bishopAttacks(square, allPieces) & ~friendlyPieces;
+            uint64_t bishopMoves = Attacks::bishopAttacks(square, allPieces) & targets & info.checkMask;
+            if (info.pinned & 1ull << square) {
+                bishopMoves &= Attacks::lineSquares(info.kingSquare, square);
+            }
             while (bishopMoves) {
-                int currSquare = popLeadingBit(bishopMoves);
-                BoardSquare move(currSquare);
-                currBoard.makeMove(bishop, move);
-                if (!currBoard.isIllegalPos) {
-                    validMoves.push_back(BoardMove(bishop, move));
-                }
-                currBoard.undoMove();
+                validMoves.push_back(Move(square, popLeadingBit(bishopMoves)));
             }
         }
     }
 
-    void validRookMoves(Board& currBoard, std::vector<BoardMove>& validMoves, uint64_t rooks) {
+    void validRookMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, uint64_t rooks, genTypes type) {
         uint64_t allPieces = currBoard.pieceSets[WHITE_PIECES] | currBoard.pieceSets[BLACK_PIECES];
-        uint64_t friendlyPieces = currBoard.isWhiteTurn ? currBoard.pieceSets[WHITE_PIECES] : currBoard.pieceSets[BLACK_PIECES];
+        uint64_t targets = moveTargets(currBoard, type);
         while (rooks) {
             int square = popLeadingBit(rooks);
-            BoardSquare rook(square);
-            uint64_t rookMoves = Attacks::rookAttacks(square, allPieces) & ~friendlyPieces;
+            uint64_t rookMoves = Attacks::rookAttacks(square, allPieces) & targets & info.checkMask;
+            if (info.pinned & 1ull << square) {
+                rookMoves &= Attacks::lineSquares(info.kingSquare, square);
+            }
             while (rookMoves) {
-                int currSquare = popLeadingBit(rookMoves);
-                BoardSquare move(currSquare);
-                currBoard.makeMove(rook, move);
-                if (!currBoard.isIllegalPos) {
-                    validMoves.push_back(BoardMove(rook, move));
-                }
-                currBoard.undoMove();
+                validMoves.push_back(Move(square, popLeadingBit(rookMoves)));
             }
         }
     }
 
-    void validQueenMoves(Board& currBoard, std::vector<BoardMove>& validMoves, uint64_t queens) {
-        validBishopMoves(currBoard, validMoves, queens);
-        validRookMoves(currBoard, validMoves, queens);
+    void validQueenMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, uint64_t queens, genTypes type) {
+        validBishopMoves(currBoard, info, validMoves, queens, type);
+        validRookMoves(currBoard, info, validMoves, queens, type);
     }
 
 
-    void validKingMoves(Board& currBoard, std::vector<BoardMove>& validMoves, uint64_t kings) {
-        int kingUnmovedRank = currBoard.isWhiteTurn ? 7 : 0;
+    void validKingMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, uint64_t kings, genTypes type) {
+        uint64_t allPieces = currBoard.pieceSets[WHITE_PIECES] | currBoard.pieceSets[BLACK_PIECES];
+        uint64_t targets = moveTargets(currBoard, type);
+        pieceTypes allyRook = currBoard.isWhiteTurn ? WRook : BRook;
         
         while (kings) {
-            BoardSquare king(popLeadingBit(kings));
-            int currRank = king.rank;
-            fileVals currFile = king.file;
-            std::vector<BoardSquare> kingMoves;
-            std::vector<BoardSquare> potentialAdjacentMoves = {
-                BoardSquare(currRank - 1, currFile - 1),
-                BoardSquare(currRank - 1, currFile),
-                BoardSquare(currRank - 1, currFile + 1),
-                BoardSquare(currRank + 1, currFile - 1),
-                BoardSquare(currRank + 1, currFile),
-                BoardSquare(currRank + 1, currFile + 1),
-                BoardSquare(currRank, currFile - 1),
-                BoardSquare(currRank, currFile + 1),
-            };
-            std::vector<BoardSquare> potentialCastleMoves = {
-                BoardSquare(currRank, currFile - 2),
-                BoardSquare(currRank, currFile + 2),
-            };
+            int square = popLeadingBit(kings);
+            BoardSquare king(square);
             // regular movements
-            for (BoardSquare square: potentialAdjacentMoves) {
-                if (square.isValid() && !isFriendlyPiece(currBoard, square)) {
-                    kingMoves.push_back(square);
-                }
+            uint64_t kingMoves = kingSquares(1ull << square) & targets & ~info.kingDanger;
+            while (kingMoves) {
+                validMoves.push_back(Move(square, popLeadingBit(kingMoves)));
             }
-            // castling
-            for (BoardSquare square: potentialCastleMoves) {
-                // check for castling rights and validity
-                if (currKingInAttack(currBoard)) {break;}
-                if (!(currBoard.castlingRights & castleRightsBit(square, currBoard.isWhiteTurn))) {continue;}
-                
-                // prevent castling through squares attacked by enemies
-                int kingFileDirection = square.file == G ? 1 : -1;
-                currBoard.makeMove(king, BoardSquare(king.rank, king.file + kingFileDirection));
-                if (currBoard.isIllegalPos) {
-                    currBoard.undoMove();
-                    continue;
-                } 
-                currBoard.undoMove();
 
-                // check for pieces in between king and rook
-                if (unblockedCastleRook(currBoard, king, kingFileDirection)) {
-                    kingMoves.push_back(BoardSquare(kingUnmovedRank, square.file));
+            // castling, the king can't castle out of, through or into check
+            if (info.checkers || king.file != E || !(type & QuietMoves)) {continue;}
+            for (int kingFileDirection: {1, -1}) {
+                BoardSquare castleSquare(king.rank, king.file + 2 * kingFileDirection);
+                BoardSquare rookSquare(king.rank, kingFileDirection == 1 ? H : A);
+                if (!(currBoard.castlingRights & castleRightsBit(castleSquare, currBoard.isWhiteTurn)) ||
+                    currBoard.getPiece(rookSquare) != allyRook) {
+                    continue;
                 }
-            }
-            
-            for (BoardSquare move: kingMoves) {
-                currBoard.makeMove(king, move);
-                if (!currBoard.isIllegalPos) {
-                    validMoves.push_back(BoardMove(king, move));
+                
+                // check for pieces in between king and rook
+                uint64_t kingPath = 1ull << (square + kingFileDirection) | 1ull << castleSquare.toSquare();
+                if (!(Attacks::betweenSquares(square, rookSquare.toSquare()) & allPieces) && !(kingPath & info.kingDanger)) {
+                    validMoves.push_back(Move(square, castleSquare.toSquare(), CastleMove));
                 }
-                currBoard.undoMove();
             }
-
         }
     }
 
-    bool unblockedCastleRook(Board& currBoard, BoardSquare king, int xDir) {
-        int currFile = king.file + xDir;
-        int targetFile = xDir == 1 ? H : A;
-        pieceTypes allyRook = currBoard.isWhiteTurn ? WRook : BRook;
+    // Checks a move that wasn't generated in this position, such as a hash move, by generating the moves of its piece.
+    // Moves are compared including their flags, so a castle can't be mistaken for a regular king move.
+    bool isLegalMove(const Board& currBoard, const LegalityInfo& info, Move move) {
+        pieceTypes piece = currBoard.getPiece(move.from());
+        if (piece == EmptyPiece || currBoard.isWhiteTurn != (piece < BKing)) {
+            return false;
+        }
+        // only the king can move out of a double check
+        if (!info.checkMask && piece % 6 != WKing) {
+            return false;
+        }
 
-        while (currFile >= A && currFile <= H) {
-            pieceTypes currPiece = currBoard.getPiece(king.rank, currFile);
-            if (currPiece == allyRook) {
+        MoveList pieceMoves;
+        uint64_t pieceBitboard = 1ull << move.from();
+        switch (piece % 6) {
+            case WKing:
+                validKingMoves(currBoard, info, pieceMoves, pieceBitboard);
                 break;
+            case WQueen:
+                validQueenMoves(currBoard, info, pieceMoves, pieceBitboard);
+                break;
+            case WBishop:
+                validBishopMoves(currBoard, info, pieceMoves, pieceBitboard);
+                break;
+            case WKnight:
+                validKnightMoves(currBoard, info, pieceMoves, pieceBitboard);
+                break;
+            case WRook:
+                validRookMoves(currBoard, info, pieceMoves, pieceBitboard);
+                break;
+            default:
+                validPawnMoves(currBoard, info, pieceMoves, pieceBitboard);
+        }
+        for (const ScoredMove& pieceMove: pieceMoves) {
+            if (pieceMove.move == move) {
+                return true;
             }
-            else if (currPiece != EmptyPiece) {
-                return false;
-            }
-            currFile += xDir;
         }
-        return currFile == targetFile;
+        return false;
+    }
+
+    // squares a piece may move to for the given type, pawns handle promotions themselves
+    uint64_t moveTargets(const Board& currBoard, genTypes type) {
+        uint64_t allPieces = currBoard.pieceSets[WHITE_PIECES] | currBoard.pieceSets[BLACK_PIECES];
+        uint64_t enemies = currBoard.isWhiteTurn ? currBoard.pieceSets[BLACK_PIECES] : currBoard.pieceSets[WHITE_PIECES];
+        uint64_t targets = NO_SQUARES;
+        if (type & NoisyMoves) {
+            targets |= enemies;
+        }
+        if (type & QuietMoves) {
+            targets |= ~allPieces;
+        }
+        return targets;
+    }
+
+    // all squares attacked by one side, allPieces is taken separately so that pieces can be seen through
+    uint64_t attackedSquares(const Board& currBoard, bool byWhite, uint64_t allPieces) {
+        uint64_t kings   = byWhite ? currBoard.pieceSets[WKing]   : currBoard.pieceSets[BKing]; 
+        uint64_t pawns   = byWhite ? currBoard.pieceSets[WPawn]   : currBoard.pieceSets[BPawn];
+        uint64_t knights = byWhite ? currBoard.pieceSets[WKnight] : currBoard.pieceSets[BKnight];
+        uint64_t queens  = byWhite ? currBoard.pieceSets[WQueen]  : currBoard.pieceSets[BQueen];
+        uint64_t diagonals = queens | (byWhite ? currBoard.pieceSets[WBishop] : currBoard.pieceSets[BBishop]);
+        uint64_t straights = queens | (byWhite ? currBoard.pieceSets[WRook]   : currBoard.pieceSets[BRook]);
+
+        uint64_t attacks = kingSquares(kings) | pawnAttacks(pawns, byWhite) | knightSquares(knights);
+        while (diagonals) {
+            attacks |= Attacks::bishopAttacks(popLeadingBit(diagonals), allPieces);
+        }
+        while (straights) {
+            attacks |= Attacks::rookAttacks(popLeadingBit(straights), allPieces);
+        }
+        return attacks;
+    }
+
+    // En passant is the only move that can uncover a check along the rank of the moving pawn,
+    // so the king's lines are recomputed with both pawns gone.
+    bool enPassantIsLegal(const Board& currBoard, const LegalityInfo& info, int pawnSquare) {
+        bool isWhite = currBoard.isWhiteTurn;
+        int targetSquare = currBoard.pawnJumpedSquare.toSquare();
+        uint64_t capturedPawn = 1ull << (targetSquare + (isWhite ? 8 : -8));
+        uint64_t allPieces = currBoard.pieceSets[WHITE_PIECES] | currBoard.pieceSets[BLACK_PIECES];
+        allPieces = (allPieces ^ 1ull << pawnSquare ^ capturedPawn) | 1ull << targetSquare;
+
+        uint64_t enemyQueens  = isWhite ? currBoard.pieceSets[BQueen]  : currBoard.pieceSets[WQueen];
+        uint64_t enemyBishops = isWhite ? currBoard.pieceSets[BBishop] : currBoard.pieceSets[WBishop];
+        uint64_t enemyRooks   = isWhite ? currBoard.pieceSets[BRook]   : currBoard.pieceSets[WRook];
+        uint64_t enemyKnights = isWhite ? currBoard.pieceSets[BKnight] : currBoard.pieceSets[WKnight];
+        uint64_t enemyPawns   = isWhite ? currBoard.pieceSets[BPawn]   : currBoard.pieceSets[WPawn];
+
+        // capturing the jumped pawn resolves its own check, but no other knight or pawn check
+        return !(info.checkers & (enemyKnights | enemyPawns) & ~capturedPawn)
+            && !(Attacks::bishopAttacks(info.kingSquare, allPieces) & (enemyBishops | enemyQueens))
+            && !(Attacks::rookAttacks(info.kingSquare, allPieces) & (enemyRooks | enemyQueens));
     }
 
     bool isFriendlyPiece(Board& currBoard, BoardSquare targetSquare) {
@@ -248,30 +330,30 @@ namespace MOVEGEN {
     // perft is a method of determining correctness of move generators
     // positions can be input and number of total leaf nodes determined
     // the number determined can be compared to a table to established values from others
-    uint64_t perft(Board board, int depthLeft) {
+    uint64_t perft(Board& board, int depthLeft) {
         if (depthLeft == 0) {
             return 1;
         }
         uint64_t leafNodeCount = 0;
-        std::vector<BoardMove> moves = moveGenerator(board);
-        for (auto move: moves) {
-            board.makeMove(move);
+        MoveList moves = moveGenerator(board);
+        for (const ScoredMove& move: moves) {
+            board.makeMove(move.move);
             uint64_t moveCount = perftHelper(board, depthLeft - 1);
             leafNodeCount += moveCount;
-            std::cout << move << ": " << moveCount << std::endl; 
+            std::cout << move.move << ": " << moveCount << std::endl; 
             board.undoMove();
         }
         return leafNodeCount;
     }
 
-    uint64_t perftHelper(Board board, int depthLeft) {
+    uint64_t perftHelper(Board& board, int depthLeft) {
         if (depthLeft == 0) {
             return 1;
         }
         uint64_t leafNodeCount = 0;
-        std::vector<BoardMove> moves = moveGenerator(board);
-        for (auto move: moves) {
-            board.makeMove(move);
+        MoveList moves = moveGenerator(board);
+        for (const ScoredMove& move: moves) {
+            board.makeMove(move.move);
             leafNodeCount += perftHelper(board, depthLeft - 1);
             board.undoMove();
         }
@@ -1,27 +1,50 @@
 #pragma once
 
 #include <cstdint>
-#include <vector>
 
 #include "board.hpp"
+#include "move.hpp"
 
 namespace MOVEGEN {
 
-    std::vector<BoardMove> moveGenerator(Board currBoard); // outputs board instead of board moves for future evaluation functions
-    void validPawnMoves(Board& currBoard, std::vector<BoardMove>& validMoves, uint64_t pawns); // includes en passant
-    void validKnightMoves(Board& currBoard, std::vector<BoardMove>& validMoves, uint64_t knights);
-    void validBishopMoves(Board& currBoard, std::vector<BoardMove>& validMoves, uint64_t bishops);
-    void validRookMoves(Board& currBoard, std::vector<BoardMove>& validMoves, uint64_t rooks);
-    void validQueenMoves(Board& currBoard, std::vector<BoardMove>& validMoves, uint64_t queens);
-    void validKingMoves(Board& currBoard, std::vector<BoardMove>& validMoves, uint64_t kings); // includes castling
+    // Noisy moves are captures and promotions, so search can try them before generating any quiet move.
+    // Quiescence only looks at captures, en passant and queen promotions.
+    enum genTypes {
+        NoisyMoves = 1,
+        QuietMoves = 2,
+        AllMoves = NoisyMoves | QuietMoves,
+        NoUnderpromotions = 4,
+        CaptureMoves = NoisyMoves | NoUnderpromotions,
+    };
 
-    bool unblockedCastleRook(Board& currBoard, BoardSquare king, int xDir); 
-    bool isFriendlyPiece(Board& currBoard, BoardSquare targetSquare);
+    // Computed once per position, so that every move is generated legal without having to make it
+    struct LegalityInfo {
+        LegalityInfo(const Board& currBoard);
+        int kingSquare;
+        uint64_t checkers;   // enemy pieces attacking the king
+        uint64_t pinned;     // allied pieces that can only move along the line between them and the king
+        uint64_t checkMask;  // squares that capture or block a single checker, all squares when not in check
+        uint64_t kingDanger; // squares attacked by the enemy, seen through the king so it can't retreat along a checking line
+    };
+
+    MoveList moveGenerator(const Board& currBoard);
+    void generateMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, genTypes type);
+    void validPawnMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, uint64_t pawns, genTypes type = AllMoves); // includes en passant
+    void validKnightMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, uint64_t knights, genTypes type = AllMoves);
+    void validBishopMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, uint64_t bishops, genTypes type = AllMoves);
+    void validRookMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, uint64_t rooks, genTypes type = AllMoves);
+    void validQueenMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, uint64_t queens, genTypes type = AllMoves);
+    void validKingMoves(const Board& currBoard, const LegalityInfo& info, MoveList& validMoves, uint64_t kings, genTypes type = AllMoves); // includes castling
 
-    void forwardPawnMoves(Board& currBoard, std::vector<BoardSquare>& pawnMoves, BoardSquare pawn);
-    void pawnCaptures(Board& currBoard, std::vector<BoardSquare>& pawnMoves, BoardSquare pawn, int fileDirection);
+    bool isLegalMove(const Board& currBoard, const LegalityInfo& info, Move move);
+    uint64_t moveTargets(const Board& currBoard, genTypes type);
+
+    uint64_t attackedSquares(const Board& currBoard, bool byWhite, uint64_t allPieces);
+    bool enPassantIsLegal(const Board& currBoard, const LegalityInfo& info, int pawnSquare);
+    bool isFriendlyPiece(Board& currBoard, BoardSquare targetSquare);
 
     // for debugging
-    uint64_t perft(Board board, int depthLeft);
-    uint64_t perftHelper(Board currBoard, int depthLeft);
-} // namespace MOVEGEN
\ No newline at end of file
+    // boards are made and undone in place, so they are unchanged after returning
+    uint64_t perft(Board& board, int depthLeft);
+    uint64_t perftHelper(Board& board, int depthLeft);
+} // namespace MOVEGEN
@@ -1,50 +1,162 @@
-#include <vector>
+#include <algorithm>
 
 #include "movePicker.hpp"
 #include "board.hpp"
 #include "move.hpp"
+#include "moveGen.hpp"
+#include "see.hpp"
 #include "types.hpp"
 
-MovePicker::MovePicker(std::vector<BoardMove>&& a_moves) {
-    this->moves = a_moves;
-    this->moveScores = std::vector<int>(moves.size());
-    this->size = moves.size();
+MovePicker::MovePicker(const Board& a_board, Move a_ttMove, std::array<Move, NUM_KILLERS> a_killers,
+                       const History* a_history) : 
+    board(a_board), info(a_board) {
     this->movesPicked = 0;
+    this->badNoisyCount = 0;
+    this->badNoisyPicked = 0;
+    this->ttMove = a_ttMove;
+    this->killers = a_killers;
+    this->killersPicked = 0;
+    this->history = a_history;
+    this->counterMove = Move();
+    this->stage = TTMoveStage;
+    this->capturesOnly = false;
+};
+
+// only captures, en passant and queen promotions are picked
+MovePicker::MovePicker(const Board& a_board, Move a_ttMove, bool a_capturesOnly) : MovePicker(a_board, a_ttMove) {
+    this->capturesOnly = a_capturesOnly;
 };
 
 // Searching moves that are likely to be better helps with pruning in search. This is move ordering.
-// More promising moves are given higher scores and then searched first.
-void MovePicker::assignMoveScores(const Board& board) {
-    size_t i = 0;
-    for (BoardMove move: this->moves) {
-        // capture
-        // moveGen outputs least valuable piece moves first, so least value captures is automatic 
-        if (board.getPiece(move.pos2) != EmptyPiece) {
-            this->moveScores[i] = 1;
-        }
-        // default
-        else {
-            this->moveScores[i] = 0;
+// Most nodes are cut off by the hash move or a capture, so quiet moves are only generated once those run out.
+Move MovePicker::pickMove() {
+    switch (this->stage) {
+        case TTMoveStage:
+            this->stage = GenerateNoisyStage;
+            // the hash move might come from a different position with the same bucket, or from another thread
+            if (!this->ttMove.isNull() && (!this->capturesOnly || this->isQuiescenceMove(this->ttMove)) &&
+                MOVEGEN::isLegalMove(this->board, this->info, this->ttMove)) {
+                return this->ttMove;
+            }
+            this->ttMove = Move();
+            // fallthrough
+        case GenerateNoisyStage:
+            MOVEGEN::generateMoves(this->board, this->info, this->moves, this->capturesOnly ? MOVEGEN::CaptureMoves : MOVEGEN::NoisyMoves);
+            this->assignNoisyScores();
+            this->stage = NoisyStage;
+            // fallthrough
+        case NoisyStage:
+            while (this->movesPicked < this->moves.size()) {
+                Move move = this->pickBestMove();
+                if (move == this->ttMove) {
+                    continue;
+                }
+                // losing captures are tried after every quiet move, and not at all in quiescence
+                if (SEE::evaluate(this->board, move) < 0) {
+                    std::swap(this->moves[this->badNoisyCount++], this->moves[this->movesPicked - 1]);
+                    continue;
+                }
+                return move;
+            }
+            if (this->capturesOnly) {
+                this->stage = FinishedStage;
+                break;
+            }
+            this->stage = KillerStage;
+            // fallthrough
+        case KillerStage:
+            while (this->killersPicked < this->killers.size()) {
+                Move killer = this->killers[this->killersPicked++];
+                if (!killer.isNull() && killer != this->ttMove && this->isQuiet(killer) &&
+                    MOVEGEN::isLegalMove(this->board, this->info, killer)) {
+                    return killer;
+                }
+                // don't skip the same move again in the quiet stage if it wasn't picked here
+                this->killers[this->killersPicked - 1] = Move();
+            }
+            this->stage = CounterMoveStage;
+            // fallthrough
+        case CounterMoveStage:
+            this->stage = GenerateQuietStage;
+            // the quiet move that last refuted the opponent's previous move
+            if (this->history) {
+                Move counter = this->history->getCounterMove(this->board);
+                if (!counter.isNull() && counter != this->ttMove && this->isQuiet(counter) &&
+                    std::find(this->killers.begin(), this->killers.end(), counter) == this->killers.end() &&
+                    MOVEGEN::isLegalMove(this->board, this->info, counter)) {
+                    this->counterMove = counter;
+                    return counter;
+                }
+            }
+            // fallthrough
+        case GenerateQuietStage:
+            this->moves.count = this->badNoisyCount;
+            this->movesPicked = this->badNoisyCount;
+            MOVEGEN::generateMoves(this->board, this->info, this->moves, MOVEGEN::QuietMoves);
+            this->assignQuietScores();
+            this->stage = QuietStage;
+            // fallthrough
+        case QuietStage:
+            while (this->movesPicked < this->moves.size()) {
+                Move move = this->pickBestMove();
+                if (move != this->ttMove && move != this->counterMove &&
+                    std::find(this->killers.begin(), this->killers.end(), move) == this->killers.end()) {
+                    return move;
+                }
+            }
+            this->stage = BadNoisyStage;
+            // fallthrough
+        case BadNoisyStage:
+            if (this->badNoisyPicked < this->badNoisyCount) {
+                return this->moves[this->badNoisyPicked++].move;
+            }
+            this->stage = FinishedStage;
+            // fallthrough
+        case FinishedStage:
+            break;
+    }
+    return Move();
+}
+
+// most valuable victim, least valuable attacker
+void MovePicker::assignNoisyScores() {
+    for (ScoredMove& scoredMove: this->moves) {
+        Move move = scoredMove.move;
+        pieceTypes attacker = this->board.getPiece(move.from());
+        // the pawn taken en passant isn't on the target square
+        pieceTypes victim = move.flag() == EnPassantMove ? (this->board.isWhiteTurn ? BPawn : WPawn) : this->board.getPiece(move.to());
+        scoredMove.score = victim == EmptyPiece ? -MVV_LVA_VALUES[attacker % 6] : MVV_LVA.scores[attacker][victim];
+        if (move.promotionPiece(this->board.isWhiteTurn) % 6 == WQueen) {
+            scoredMove.score += QUEEN_PROMOTION_BONUS;
         }
-        i++;
     }
 }
 
-bool MovePicker::movesLeft() const {
-    return this->movesPicked < this->size;
+// the losing noisy moves kept at the front of the list are returned in their own stage
+void MovePicker::assignQuietScores() {
+    for (size_t i = this->badNoisyCount; i < this->moves.size(); i++) {
+        this->moves[i].score = this->history ? this->history->getQuietScore(this->board, this->moves[i].move) : 0;
+    }
 }
 
 // Due to pruning, we don't need to sort the entire array of moves for move ordering.
-// When sorting only small portions of arrays, using insertion sort is faster.
-BoardMove MovePicker::pickMove() {
-    auto begin = this->moveScores.begin() + this->movesPicked;
-    auto end = this->moveScores.end();
-    size_t maxIndex = std::distance(this->moveScores.begin(), std::max_element(begin, end));
+// Only the best remaining move is selected each time.
+Move MovePicker::pickBestMove() {
+    ScoredMove* best = std::max_element(this->moves.begin() + this->movesPicked, this->moves.end(),
+        [](const ScoredMove& lhs, const ScoredMove& rhs) {return lhs.score < rhs.score;});
     
-    std::swap(this->moveScores[maxIndex], this->moveScores[movesPicked]);
-    std::swap(this->moves[maxIndex], this->moves[movesPicked]);
-    BoardMove move = this->moves[movesPicked];
+    std::swap(*best, this->moves[this->movesPicked]);
+    Move move = this->moves[this->movesPicked].move;
     
     this->movesPicked++;
     return move;
-}
\ No newline at end of file
+}
+
+bool MovePicker::isQuiet(Move move) const {
+    return move.flag() != PromotionMove && !this->board.moveIsCapture(move);
+}
+
+// matches the moves generated for quiescence
+bool MovePicker::isQuiescenceMove(Move move) const {
+    return this->board.moveIsCapture(move) || move.promotionPiece(this->board.isWhiteTurn) == (this->board.isWhiteTurn ? WQueen : BQueen);
+}
@@ -1,21 +1,77 @@
 #pragma once
 
-#include <vector>
+#include <array>
 
 #include "board.hpp"
+#include "history.hpp"
 #include "move.hpp"
+#include "moveGen.hpp"
 #include "types.hpp"
 
+constexpr int NUM_KILLERS = 2;
+
+// piece values for capture ordering, indexed by piece % 6; the king only ever attacks
+constexpr std::array<int, 6> MVV_LVA_VALUES = {10, 9, 3, 3, 5, 1};
+// a queen promotion gains about as much as capturing a queen, underpromotions are ordered after captures
+constexpr int QUEEN_PROMOTION_BONUS = 16 * (MVV_LVA_VALUES[WQueen] - MVV_LVA_VALUES[WPawn]);
+
+// most valuable victim first, then least valuable attacker, indexed by [attacker][victim]
+struct MvvLvaTable {
+    int scores[NUM_PIECE_TYPES][NUM_PIECE_TYPES];
+};
+
+constexpr MvvLvaTable makeMvvLvaTable() {
+    MvvLvaTable table = {};
+    for (int attacker = 0; attacker < NUM_PIECE_TYPES; attacker++) {
+        for (int victim = 0; victim < NUM_PIECE_TYPES; victim++) {
+            table.scores[attacker][victim] = 16 * MVV_LVA_VALUES[victim % 6] - MVV_LVA_VALUES[attacker % 6];
+        }
+    }
+    return table;
+}
+
+constexpr MvvLvaTable MVV_LVA = makeMvvLvaTable();
+static_assert(MVV_LVA.scores[WPawn][BQueen] > MVV_LVA.scores[WQueen][BQueen], "less valuable attackers go first");
+static_assert(MVV_LVA.scores[WQueen][BRook] > MVV_LVA.scores[WPawn][BKnight], "more valuable victims go first");
+
+// moves are handed out in stages, each stage is only generated once the previous one runs out
+enum pickerStages {
+    TTMoveStage,
+    GenerateNoisyStage,
+    NoisyStage,
+    KillerStage,
+    CounterMoveStage,
+    GenerateQuietStage,
+    QuietStage,
+    BadNoisyStage,
+    FinishedStage,
+};
+
 class MovePicker {
     public:
-        MovePicker(std::vector<BoardMove>&& a_moves); 
-        void assignMoveScores(const Board& board);
-        bool movesLeft() const;
-        BoardMove pickMove();
+        MovePicker(const Board& a_board, Move a_ttMove = Move(), std::array<Move, NUM_KILLERS> a_killers = {},
+                   const History* a_history = nullptr);
+        MovePicker(const Board& a_board, Move a_ttMove, bool a_capturesOnly); // for quiescence
+        Move pickMove(); // returns a null move once every legal move has been picked
     
     private:
-        std::vector<BoardMove> moves;
-        std::vector<int> moveScores;
-        int movesPicked;
-        int size;
-};
\ No newline at end of file
+        void assignNoisyScores();
+        void assignQuietScores();
+        Move pickBestMove();
+        bool isQuiet(Move move) const;
+        bool isQuiescenceMove(Move move) const;
+
+        const Board& board; // must be in the same position whenever a move is picked
+        MOVEGEN::LegalityInfo info;
+        MoveList moves;
+        size_t movesPicked;
+        size_t badNoisyCount; // noisy moves that lose material are moved to the front of the list
+        size_t badNoisyPicked;
+        Move ttMove;
+        std::array<Move, NUM_KILLERS> killers;
+        size_t killersPicked;
+        const History* history; // quiet moves are left unordered without one
+        Move counterMove;
+        pickerStages stage;
+        bool capturesOnly;
+};
@@ -1,7 +1,11 @@
+#include <algorithm>
 #include <vector>
 #include <utility>
 #include <iostream>
 #include <chrono>
+#include <memory>
+#include <thread>
+#include <cmath>
 
 #include "search.hpp"
 #include "movePicker.hpp"
@@ -9,95 +13,489 @@
 #include "moveGen.hpp"
 #include "board.hpp"
 #include "timeman.hpp"
+#include "tt.hpp"
 
 namespace Search {
+    std::array<std::array<int, MAX_MOVES>, MAX_PLY> reductions;
+
+    // Reductions grow with the logarithm of both the depth and the move number, since late moves
+    // in a well ordered list rarely turn out best, and deep searches can afford to verify them less.
+    void init() {
+        for (int depth = 1; depth < MAX_PLY; depth++) {
+            for (int moveNumber = 1; moveNumber < MAX_MOVES; moveNumber++) {
+                reductions[depth][moveNumber] = int(0.75 + std::log(depth) * std::log(moveNumber) / 2.25);
+            }
+        }
+    }
+
+    // quiet moves after this many are skipped at shallow depth
+    int lateMovePruningCount(int depthLeft) {
+        return 3 + depthLeft * depthLeft;
+    }
+
+    ThreadPool::~ThreadPool() {
+        this->stopThinking();
+        this->waitForThinking();
+    }
+
+    void ThreadPool::setThreads(int a_numThreads) {
+        this->numThreads = a_numThreads;
+    }
+
+    // returns immediately, the listener is called from the search thread
+    // A ponder search runs without a time limit until ponderhit, then continues as the real search,
+    // so the work done on the opponent's time is kept. Time spent pondering counts towards the time limit.
+    void ThreadPool::startThinking(const Board& board, Limits limits, Listener listener) {
+        this->waitForThinking();
+        // reset before the thread starts, so that a stop sent right after can't be lost
+        this->stop = false;
+        this->pondering = limits.ponder;
+        this->mainThread = std::thread([this, board, limits, listener]() {
+            Info result = this->think(board, limits, listener);
+            if (listener.onFinish) {
+                listener.onFinish(result);
+            }
+        });
+    }
+
+    void ThreadPool::stopThinking() {
+        this->stop = true;
+    }
+
+    // the opponent played the expected move
+    void ThreadPool::ponderhit() {
+        this->pondering = false;
+    }
+
+    void ThreadPool::waitForThinking() {
+        if (this->mainThread.joinable()) {
+            this->mainThread.join();
+        }
+    }
+
+    static uint64_t totalNodes(const std::vector<std::unique_ptr<Searcher>>& searchers) {
+        uint64_t nodes = 0;
+        for (const std::unique_ptr<Searcher>& searcher: searchers) {
+            nodes += searcher->getNodes();
+        }
+        return nodes;
+    }
+
+    Info ThreadPool::think(const Board& board, Limits limits, const Listener& listener) {
+        TT::table.newSearch();
+
+        std::vector<std::unique_ptr<Searcher>> searchers;
+        // reports count the nodes of every thread, not only the main one
+        Listener mainListener = listener;
+        if (listener.onIteration) {
+            mainListener.onIteration = [&searchers, &listener](const Info& info) {
+                Info total = info;
+                total.nodes = totalNodes(searchers);
+                listener.onIteration(total);
+            };
+        }
+        for (int i = 0; i < this->numThreads; i++) {
+            searchers.push_back(std::make_unique<Searcher>(board, limits, i, &this->stop, &this->pondering,
+                                                           i == 0 ? mainListener : Listener()));
+        }
+        std::vector<std::thread> helpers;
+        for (int i = 1; i < this->numThreads; i++) {
+            helpers.emplace_back([&searchers, i]() {searchers[i]->startThinking();});
+        }
+
+        // helpers search until the main thread finishes
+        Info result = searchers[0]->startThinking();
+        // bestmove can't be sent while pondering or in an infinite search, even if the search has nothing left to do
+        while ((this->pondering || limits.infinite) && !this->stop) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        this->stop = true;
+        for (std::thread& helper: helpers) {
+            helper.join();
+        }
+
+        result.nodes = totalNodes(searchers);
+        return result;
+    }
+
     Info Searcher::startThinking() {
         Info result;
         Node root;
 
         // perform iterative deepening
-        for(int i = 1; i <= this->depth_limit; i++) {
-            root = this->search(MIN_ALPHA, MAX_BETA, i, 0);
+        // odd helper threads search one ply deeper so that threads spread over different depths
+        int depthOffset = this->threadId % 2;
+        int bestMoveStability = 0, scoreDrop = 0;
+        // helpers only search the best line, they are there to fill the transposition table
+        int numLines = 1;
+        if (this->threadId == 0) {
+            numLines = std::max(std::min(this->limits.multiPV, int(MOVEGEN::moveGenerator(this->board).size())), 1);
+        }
+        // go mate: a full width search as deep as the mate is long proves whether it exists
+        int maxDepth = this->limits.depth;
+        if (this->limits.mate > 0) {
+            maxDepth = std::min(maxDepth, 2 * this->limits.mate - 1);
+        }
+        std::vector<Info> lines;
+        for(int i = 1; i + depthOffset <= maxDepth; i++) {
+            // MultiPV: every further line is a search of the root without the moves already found
+            std::vector<Info> previousLines = lines;
+            lines.clear();
+            this->excludedRootMoves.clear();
+            this->rootDepth = i + depthOffset;
+            for (int lineIndex = 0; lineIndex < numLines; lineIndex++) {
+                if (this->limits.mate > 0) {
+                    // only a mate in time can beat alpha, so everything else fails low as fast as possible
+                    root = this->search(mateIn(2 * this->limits.mate), MAX_BETA, i + depthOffset, 0);
+                }
+                else if (lineIndex < int(previousLines.size()) && i + depthOffset >= ASPIRATION_MIN_DEPTH) {
+                    root = this->aspirationSearch(i + depthOffset, previousLines[lineIndex].eval);
+                }
+                else {
+                    root = this->search(MIN_ALPHA, MAX_BETA, i + depthOffset, 0);
+                }
+                if (this->isStopped()) {
+                    break;
+                }
+                // a fail low only proves there is no mate in time yet, its score isn't worth reporting
+                if (this->limits.mate > 0 && root.eval <= mateIn(2 * this->limits.mate)) {
+                    break;
+                }
+                Info line;
+                line.depth = i + depthOffset;
+                line.eval = root.eval;
+                line.move = root.move;
+                line.pv.assign(this->pvTable[0].begin(), this->pvTable[0].begin() + this->pvLength[0]);
+                lines.push_back(line);
+                this->excludedRootMoves.push_back(root.move);
+            }
             
-            if(this->tm.timeUp()) {
-                result.nodes = this->nodes;
-                result.timeElapsed = this->tm.getTimeElapsed();
+            if(this->isStopped()) {
                 break;
             }
-            else {
-                result.depth = this->max_depth;
-                result.eval = root.eval;
-                result.move = root.move;
+            else if (!lines.empty()) {
+                // a later line can score higher when the transposition table hands it a deeper result
+                std::stable_sort(lines.begin(), lines.end(), [](const Info& a, const Info& b) {return a.eval > b.eval;});
+                bestMoveStability = lines[0].move == result.move ? bestMoveStability + 1 : 0;
+                scoreDrop = result.depth > 0 ? result.eval - lines[0].eval : 0;
+                result = lines[0];
+                for (int lineIndex = 0; lineIndex < int(lines.size()) && this->listener.onIteration; lineIndex++) {
+                    lines[lineIndex].multiPV = lineIndex + 1;
+                    this->addStatistics(lines[lineIndex]);
+                    this->listener.onIteration(lines[lineIndex]);
+                }
+            }
+            // the next iteration would likely be interrupted, or isn't worth it anymore
+            // helpers keep searching until the main thread stops them
+            if (this->threadId == 0 && this->softTimeUp(bestMoveStability, scoreDrop)) {
+                break;
+            }
+            // go mate: any mate for us within the requested number of moves is good enough
+            if (this->limits.mate > 0 && result.eval >= mateIn(2 * this->limits.mate - 1)) {
+                break;
             }
         }
+        // stopped before the first iteration finished, any legal move is better than none
+        if (result.move.isNull()) {
+            MoveList moves = MOVEGEN::moveGenerator(this->board);
+            if (moves.size() > 0) {
+                result.move = moves[0].move;
+                result.pv = {result.move};
+            }
+        }
+        result.ponderMove = result.pv.size() > 1 ? result.pv[1] : this->getPonderMove(result.move);
+        this->addStatistics(result);
+        return result;
+    }
+
+    // fills in everything about the search so far that doesn't come from the root node
+    void Searcher::addStatistics(Info& info) const {
+        info.nodes = this->getNodes();
+        info.timeElapsed = this->tm.getTimeElapsed();
+        info.selDepth = this->max_depth;
+        info.hashfull = TT::table.hashfull();
 
         // compute mate-in
-        if (root.eval > MAX_BETA - 100) {
-            result.mateIn = MAX_BETA - root.eval;
+        info.mateIn = NO_MATE;
+        if (isMateScore(info.eval)) {
+            info.mateIn = info.eval > 0 ? MAX_BETA - info.eval : info.eval - MIN_ALPHA;
         }
-        if (root.eval < MIN_ALPHA + 100) {
-            result.mateIn = root.eval - MIN_ALPHA;
+    }
+
+    // the line from this ply is move followed by the best line of the child
+    void Searcher::updatePV(Move move, int distanceFromRoot) {
+        int childLength = this->pvLength[distanceFromRoot + 1];
+        this->pvTable[distanceFromRoot][0] = move;
+        std::copy(this->pvTable[distanceFromRoot + 1].begin(), this->pvTable[distanceFromRoot + 1].begin() + childLength,
+                  this->pvTable[distanceFromRoot].begin() + 1);
+        this->pvLength[distanceFromRoot] = childLength + 1;
+    }
+
+    uint64_t Searcher::getNodes() const {
+        return this->nodes.load(std::memory_order_relaxed);
+    }
+
+    // Reading the clock at every node is measurable, so the limits are only checked every few nodes
+    // and the answer is kept. The node limit shortens the interval so that it isn't overshot.
+    bool Searcher::isStopped() {
+        if (this->stopped || --this->nodesUntilStopCheck > 0) {
+            return this->stopped;
         }
-        return result;
+        uint64_t searched = this->getNodes();
+        uint64_t nodesLeft = this->limits.nodes > searched ? this->limits.nodes - searched : 0;
+        this->nodesUntilStopCheck = STOP_CHECK_INTERVAL;
+        if (this->limits.nodes > 0 && nodesLeft < STOP_CHECK_INTERVAL) {
+            this->nodesUntilStopCheck = std::max(int(nodesLeft), 1);
+        }
+        this->stopped = (this->stop && this->stop->load(std::memory_order_relaxed)) || 
+                        (this->limits.nodes > 0 && searched >= this->limits.nodes) ||
+                        (!(this->pondering && this->pondering->load(std::memory_order_relaxed)) && this->tm.timeUp());
+        return this->stopped;
+    }
+
+    // Searches the root with a narrow window around the score of the previous iteration,
+    // widening the side that failed until the score falls inside it.
+    Node Searcher::aspirationSearch(int depth, int previousEval) {
+        if (isMateScore(previousEval)) {
+            return this->search(MIN_ALPHA, MAX_BETA, depth, 0);
+        }
+        int delta = ASPIRATION_WINDOW;
+        int alpha = previousEval - delta, beta = previousEval + delta;
+        while (true) {
+            Node root = this->search(alpha, beta, depth, 0);
+            if (this->isStopped()) {
+                return root;
+            }
+            if (root.eval <= alpha && alpha > MIN_ALPHA) {
+                alpha = std::max(root.eval - delta, MIN_ALPHA);
+            }
+            else if (root.eval >= beta && beta < MAX_BETA) {
+                beta = std::min(root.eval + delta, MAX_BETA);
+            }
+            else {
+                return root;
+            }
+            delta *= 2;
+        }
+    }
+
+    // Uses more of the planned time when the best move keeps changing or the score is falling,
+    // and less when the same move has won several iterations in a row.
+    bool Searcher::softTimeUp(int bestMoveStability, int scoreDrop) const {
+        if (this->pondering && this->pondering->load(std::memory_order_relaxed)) {
+            return false;
+        }
+        int stabilityScale = BEST_MOVE_STABILITY_SCALE[std::min(bestMoveStability, int(BEST_MOVE_STABILITY_SCALE.size()) - 1)];
+        int scoreScale = 100 + std::min(std::max(scoreDrop, 0), MAX_SCORE_DROP_SCALE);
+        return this->tm.softTimeUp(stabilityScale * scoreScale / 100);
+    }
+
+    // the hash move of the position after bestMove, which is the second move of the principal variation
+    Move Searcher::getPonderMove(Move bestMove) {
+        Move ponderMove;
+        TT::Entry entry;
+        if (bestMove.isNull()) {
+            return ponderMove;
+        }
+        this->board.makeMove(bestMove);
+        if (TT::table.probe(this->board.zobristKey, entry) && 
+            MOVEGEN::isLegalMove(this->board, MOVEGEN::LegalityInfo(this->board), entry.getMove())) {
+            ponderMove = entry.getMove();
+        }
+        this->board.undoMove();
+        return ponderMove;
     }
 
     Node Searcher::search(int alpha, int beta, int depthLeft, int distanceFromRoot) {
         Node result;
-        if(this->tm.timeUp()) {
+        this->pvLength[distanceFromRoot] = 0;
+        if(this->isStopped()) {
             return result;
         }
 
-        this->nodes++;
+        this->nodes.store(this->nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
         this->max_depth = distanceFromRoot > this->max_depth ? distanceFromRoot : this->max_depth;
 
+        // too deep to keep a principal variation or killers
+        if (distanceFromRoot >= MAX_PLY) {
+            result.eval = this->board.getEvalScore();
+            return result;
+        }
+
         // fifty move rule
         if (this->board.fiftyMoveRule == 100) {
             result.eval = 0;
             return result;
         }
-        // three-fold repetition
-        std::vector<uint64_t> currKeyHistory = this->board.zobristKeyHistory;
-        std::sort(currKeyHistory.begin(), currKeyHistory.end());
-        auto lBound = std::lower_bound(currKeyHistory.begin(), currKeyHistory.end(), this->board.zobristKey);
-        auto rBound = std::upper_bound(currKeyHistory.begin(), currKeyHistory.end(), this->board.zobristKey);
-        if (distance(lBound, rBound) == 3) {
+        // three-fold repetition, or any repetition of a position reached during this search
+        if (this->board.isRepetition(distanceFromRoot)) {
             result.eval = 0;
             return result;
         }
+        // mate distance pruning: nothing here can be better than mating on the next move or worse than
+        // being mated now, so a shorter mate already found elsewhere makes the whole subtree irrelevant
+        if (distanceFromRoot > 0) {
+            alpha = std::max(alpha, matedIn(distanceFromRoot));
+            beta = std::min(beta, mateIn(distanceFromRoot + 1));
+            if (alpha >= beta) {
+                result.eval = alpha;
+                return result;
+            }
+        }
         // max depth reached
-        if (depthLeft == 0) {
-            result.eval = quiesce(alpha, beta, 5);
+        if (depthLeft <= 0) {
+            result.eval = quiesce(alpha, beta, QUIESCENCE_DEPTH, distanceFromRoot);
             return result;
         }
-        // checkmate or stalemate
-        std::vector<BoardMove> moves = MOVEGEN::moveGenerator(this->board);
-        if (moves.size() == 0) {
-            if (currKingInAttack(board)) {
-                result.eval = MIN_ALPHA + distanceFromRoot;
+        // go mate has to prove the mate, so nothing is pruned or reduced on a guess
+        bool isMateSolver = this->limits.mate > 0;
+        // transposition table cutoff, the root always searches so that it has a move to return.
+        // go mate only trusts mate scores, other bounds may come from a normal search that pruned the mate away.
+        TT::Entry entry;
+        Move ttMove;
+        if (TT::table.probe(this->board.zobristKey, entry)) {
+            int ttScore = scoreFromTT(entry.score, distanceFromRoot);
+            ttMove = entry.getMove();
+            if (distanceFromRoot > 0 && entry.depth >= depthLeft && (!isMateSolver || isMateScore(ttScore)) &&
+                ((entry.bound() == TT::ExactBound) ||
+                 (entry.bound() == TT::LowerBound && ttScore >= beta) ||
+                 (entry.bound() == TT::UpperBound && ttScore <= alpha))) {
+                result.eval = ttScore;
+                result.move = ttMove;
+                return result;
             }
-            else {
-                result.eval = 0;
+        }
+        bool isPVNode = beta - alpha > 1;
+        bool inCheck = this->board.isInCheck;
+        bool isMateBound = alpha < MIN_ALPHA + MATE_THRESHOLD || beta > MAX_BETA - MATE_THRESHOLD;
+        int staticEval = this->board.getEvalScore();
+
+        // frontier pruning, trusting the static eval close to the leaves
+        if (!isPVNode && !inCheck && !isMateBound && !isMateSolver) {
+            // reverse futility pruning: too far above beta for the opponent to catch up in the moves left
+            if (depthLeft < int(REVERSE_FUTILITY_MARGINS.size()) && staticEval - REVERSE_FUTILITY_MARGINS[depthLeft] >= beta) {
+                result.eval = staticEval - REVERSE_FUTILITY_MARGINS[depthLeft];
+                return result;
+            }
+            // razoring: too far below alpha for a quiet move to help, so only captures are checked
+            if (depthLeft < int(RAZORING_MARGINS.size()) && staticEval + RAZORING_MARGINS[depthLeft] < alpha) {
+                int razorScore = this->quiesce(alpha - 1, alpha, QUIESCENCE_DEPTH, distanceFromRoot);
+                if (razorScore < alpha) {
+                    result.eval = razorScore;
+                    return result;
+                }
             }
-            return result;
         }
+        bool canFutilityPrune = !isPVNode && !inCheck && !isMateBound && !isMateSolver &&
+                                depthLeft < int(FUTILITY_MARGINS.size()) && staticEval + FUTILITY_MARGINS[depthLeft] <= alpha;
 
-        // init movePicker
-        MovePicker movePicker(std::move(moves));
-        movePicker.assignMoveScores(board);
+        // null move pruning: if the position is still good enough after passing the turn, a real move almost
+        // certainly is too. Not done in check, in pawn endings where zugzwang is common, twice in a row,
+        // or in principal variation nodes.
+        if (!isPVNode && !isMateSolver && depthLeft >= NULL_MOVE_MIN_DEPTH && distanceFromRoot >= this->nullMoveMinPly &&
+            !inCheck && beta < MAX_BETA - MATE_THRESHOLD && this->board.hasNonPawnMaterial() &&
+            !this->board.moveHistory.empty() && !this->board.moveHistory.back().move.isNull() &&
+            staticEval >= beta) {
+            int reduction = 3 + depthLeft / 6;
+            this->board.makeNullMove();
+            int nullScore = -1 * search(-1 * beta, -1 * beta + 1, depthLeft - 1 - reduction, distanceFromRoot + 1).eval;
+            this->board.undoNullMove();
+            if (this->isStopped()) {
+                return result;
+            }
+            if (nullScore >= beta) {
+                // a mate found without moving isn't proven
+                nullScore = nullScore >= MAX_BETA - MATE_THRESHOLD ? beta : nullScore;
+                if (depthLeft < NULL_MOVE_VERIFICATION_DEPTH || this->nullMoveMinPly > 0) {
+                    result.eval = nullScore;
+                    return result;
+                }
+                // deep cutoffs are verified with a reduced normal search, without null moves near this node
+                this->nullMoveMinPly = distanceFromRoot + 3 * (depthLeft - reduction) / 4;
+                int verifiedScore = search(beta - 1, beta, depthLeft - reduction, distanceFromRoot).eval;
+                this->nullMoveMinPly = 0;
+                if (verifiedScore >= beta) {
+                    result.eval = nullScore;
+                    return result;
+                }
+            }
+        }
+
+        // init movePicker, only now so that nodes pruned above don't pay for its legality info
+        std::array<Move, NUM_KILLERS> plyKillers = distanceFromRoot < MAX_PLY ? this->killers[distanceFromRoot] : std::array<Move, NUM_KILLERS>();
+        MovePicker movePicker(this->board, ttMove, plyKillers, this->history.get());
 
         // start search through moves
-        int score, bestscore = MIN_ALPHA;
-        while (movePicker.movesLeft()) {
-            BoardMove move = movePicker.pickMove();
+        int score, bestscore = MIN_ALPHA, originalAlpha = alpha, movesSearched = 0;
+        MoveList quietsTried;
+        Move move;
+        while (!(move = movePicker.pickMove()).isNull()) {
+            if (distanceFromRoot == 0 && std::find(this->excludedRootMoves.begin(), this->excludedRootMoves.end(), move) != this->excludedRootMoves.end()) {
+                continue;
+            }
+            bool isQuiet = move.flag() != PromotionMove && !this->board.moveIsCapture(move);
+            bool isKiller = std::find(plyKillers.begin(), plyKillers.end(), move) != plyKillers.end();
+
+            // late move pruning: at shallow depth, quiet moves this far down the list are very unlikely to matter
+            if (!isPVNode && !isMateSolver && isQuiet && depthLeft <= LMP_MAX_DEPTH && !inCheck &&
+                bestscore > MIN_ALPHA + MATE_THRESHOLD && movesSearched >= lateMovePruningCount(depthLeft)) {
+                continue;
+            }
+            // futility pruning: this node is so far below alpha that quiet moves can't bring it back,
+            // unless they give check
+            if (canFutilityPrune && isQuiet && !isKiller && movesSearched > 0 && !this->board.givesCheck(move)) {
+                continue;
+            }
+
+            movesSearched++;
+            if (isQuiet) {
+                quietsTried.push_back(move);
+            }
+            if (distanceFromRoot == 0 && this->listener.onCurrMove && this->tm.getTimeElapsed() >= CURRMOVE_MIN_TIME) {
+                this->listener.onCurrMove(depthLeft, move, movesSearched);
+            }
             board.makeMove(move);
-            Node opponent = search(-1 * beta, -1 * alpha, depthLeft - 1, distanceFromRoot + 1);
+            bool givesCheck = this->board.isInCheck;
+            // check extension: checks are searched a ply deeper so that forcing lines aren't cut off at the horizon,
+            // up to twice the iteration depth so that long checking sequences can't blow up the search
+            int newDepth = depthLeft - 1 + (givesCheck && distanceFromRoot < 2 * this->rootDepth);
+            // principal variation search: moves after the first only have to be proven no better than alpha,
+            // which a null window does cheaper, and are searched again if they turn out better
+            if (movesSearched == 1) {
+                score = -1 * search(-1 * beta, -1 * alpha, newDepth, distanceFromRoot + 1).eval;
+            }
+            else {
+                // late move reductions: late quiet moves get a shallower null window search first,
+                // and a full depth one only if they beat alpha anyway
+                int reduction = 0;
+                if (!isMateSolver && depthLeft >= LMR_MIN_DEPTH && movesSearched > LMR_MIN_MOVES && isQuiet && !isKiller &&
+                    !inCheck && !givesCheck) {
+                    reduction = reductions[std::min(depthLeft, MAX_PLY - 1)][std::min(movesSearched, MAX_MOVES - 1)];
+                    reduction -= isPVNode;
+                    reduction = std::min(std::max(reduction, 0), newDepth - 1);
+                }
+                score = -1 * search(-1 * alpha - 1, -1 * alpha, newDepth - reduction, distanceFromRoot + 1).eval;
+                if (score > alpha && reduction > 0) {
+                    score = -1 * search(-1 * alpha - 1, -1 * alpha, newDepth, distanceFromRoot + 1).eval;
+                }
+                if (score > alpha && score < beta) {
+                    score = -1 * search(-1 * beta, -1 * alpha, newDepth, distanceFromRoot + 1).eval;
+                }
+            }
             board.undoMove(); 
-            
-            score = -1 * opponent.eval;
+            // an interrupted search has no score, so nothing is learned from it
+            if (this->isStopped()) {
+                return result;
+            }
             
             // prune if a move is too good; opponent side will avoid playing into this node
             if (score >= beta) {
                 result.eval = beta;
+                result.move = move;
+                if (isQuiet) {
+                    this->storeKiller(move, distanceFromRoot);
+                    this->history->update(this->board, move, quietsTried, depthLeft);
+                }
                 break;
             }
             // fail-soft stabilizes the search and allows for returned values outside the alpha-beta bounds
@@ -106,47 +504,125 @@ namespace Search {
                 result.move = move;
                 if (score > alpha) {
                     alpha = score;
+                    this->updatePV(move, distanceFromRoot);
                 }
             }
         }
+
+        // checkmate or stalemate
+        if (movesSearched == 0) {
+            result.eval = inCheck ? matedIn(distanceFromRoot) : 0;
+            return result;
+        }
+
+        // results of an interrupted search are incomplete,
+        // and a root that skipped MultiPV moves doesn't have the score of the position
+        if (this->isStopped() || (distanceFromRoot == 0 && !this->excludedRootMoves.empty())) {
+            return result;
+        }
+        TT::Bound bound = result.eval >= beta ? TT::LowerBound : result.eval > originalAlpha ? TT::ExactBound : TT::UpperBound;
+        TT::table.store(this->board.zobristKey, depthLeft, scoreToTT(result.eval, distanceFromRoot), bound, result.move);
         return result;
     }
 
-    int Searcher::quiesce(int alpha, int beta, int depthLeft) {
-        if(this->tm.timeUp()) {
+    int Searcher::quiesce(int alpha, int beta, int depthLeft, int distanceFromRoot) {
+        if(this->isStopped()) {
             return -1;
         }
 
-        this->nodes++;
+        this->nodes.store(this->nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        this->max_depth = distanceFromRoot > this->max_depth ? distanceFromRoot : this->max_depth;
 
+        // any stored search is at least as deep as quiescence, but go mate only trusts mate scores
+        TT::Entry entry;
+        Move ttMove;
+        if (TT::table.probe(this->board.zobristKey, entry)) {
+            int ttScore = scoreFromTT(entry.score, distanceFromRoot);
+            ttMove = entry.getMove();
+            if ((this->limits.mate == 0 || isMateScore(ttScore)) &&
+                ((entry.bound() == TT::ExactBound) ||
+                 (entry.bound() == TT::LowerBound && ttScore >= beta) ||
+                 (entry.bound() == TT::UpperBound && ttScore <= alpha))) {
+                return ttScore;
+            }
+        }
+
+        int originalAlpha = alpha;
         int stand_pat = this->board.getEvalScore();
-        if(stand_pat >= beta)
+        // in check there is no standing pat, every evasion has to be searched
+        bool inCheck = this->board.isInCheck;
+        if(!inCheck && stand_pat >= beta)
             return beta;
-        if(alpha < stand_pat)
+        if(!inCheck && alpha < stand_pat)
             alpha = stand_pat;
         if(depthLeft == 0)
             return stand_pat;
 
-        std::vector<BoardMove> moves = MOVEGEN::moveGenerator(this->board);
-        MovePicker movePicker(std::move(moves));
-        movePicker.assignMoveScores(board);
+        MovePicker movePicker(this->board, ttMove, !inCheck);
 
-        int score = MIN_ALPHA;
-        while (movePicker.movesLeft()) {
-            BoardMove move = movePicker.pickMove();
-            if(!board.moveIsCapture(move))
-                continue;
+        int score = MIN_ALPHA, movesSearched = 0;
+        Move bestMove, move;
+        while (!(move = movePicker.pickMove()).isNull()) {
+            movesSearched++;
             board.makeMove(move);
-            score = -1 * (quiesce(-1 * beta, -1 * alpha, depthLeft - 1));
+            score = -1 * (quiesce(-1 * beta, -1 * alpha, depthLeft - 1, distanceFromRoot + 1));
             board.undoMove(); 
 
-            if(score >= beta)
-                return beta;
-            if(score > alpha)
+            if(score >= beta) {
+                alpha = beta;
+                bestMove = move;
+                break;
+            }
+            if(score > alpha) {
                 alpha = score;
+                bestMove = move;
+            }
+        }
+        if (inCheck && movesSearched == 0) {
+            return matedIn(distanceFromRoot);
         }
+
+        if (this->isStopped()) {
+            return alpha;
+        }
+        TT::Bound bound = alpha >= beta ? TT::LowerBound : alpha > originalAlpha ? TT::ExactBound : TT::UpperBound;
+        TT::table.store(this->board.zobristKey, 0, scoreToTT(alpha, distanceFromRoot), bound, bestMove);
         return alpha;
+    }
+
+    // two killers per ply, the newest first
+    void Searcher::storeKiller(Move move, int distanceFromRoot) {
+        if (distanceFromRoot >= MAX_PLY || this->killers[distanceFromRoot][0] == move) {
+            return;
+        }
+        this->killers[distanceFromRoot][1] = this->killers[distanceFromRoot][0];
+        this->killers[distanceFromRoot][0] = move;
+    }
+
+    int mateIn(int ply) {
+        return MAX_BETA - ply;
+    }
+
+    int matedIn(int ply) {
+        return MIN_ALPHA + ply;
+    }
+
+    bool isMateScore(int score) {
+        return score > MAX_BETA - MATE_THRESHOLD || score < MIN_ALPHA + MATE_THRESHOLD;
+    }
 
+    int scoreToTT(int score, int distanceFromRoot) {
+        if (!isMateScore(score)) {
+            return score;
+        }
+        return score > 0 ? score + distanceFromRoot : score - distanceFromRoot;
+    }
+
+    int scoreFromTT(int score, int distanceFromRoot) {
+        if (!isMateScore(score)) {
+            return score;
+        }
+        return score > 0 ? score - distanceFromRoot : score + distanceFromRoot;
     }
 
 } // namespace Search
\ No newline at end of file
@@ -1,52 +1,174 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <utility>
 #include <chrono>
+#include <thread>
+#include <vector>
 
 #include "board.hpp"
 #include "eval.hpp"
+#include "history.hpp"
+#include "movePicker.hpp"
 #include "timeman.hpp"
 
 namespace Search {
     const int MIN_ALPHA = -1000000;
     const int MAX_BETA = 1000000;
     const int NO_MATE = -1;
+    const int MATE_THRESHOLD = 1000; // scores within this distance of MIN_ALPHA or MAX_BETA are mates
     const int TIME_LIMIT_TEST = 1000000; //time in microseconds
+    const int MAX_PLY = 256;
+    const int QUIESCENCE_DEPTH = 5;
+    const int STOP_CHECK_INTERVAL = 1024; // nodes between reads of the clock and the shared stop flag
+    const int ASPIRATION_WINDOW = 75; // initial distance of the root window from the previous iteration's score
+    const int ASPIRATION_MIN_DEPTH = 4; // shallower scores are too unstable to center a window on
+    const int NULL_MOVE_MIN_DEPTH = 3;
+    const int NULL_MOVE_VERIFICATION_DEPTH = 10; // from this depth a null move cutoff is only trusted after a normal search agrees
+    const int LMR_MIN_DEPTH = 3;
+    const int LMR_MIN_MOVES = 3; // moves searched at full depth before late quiet moves are reduced
+    const int LMP_MAX_DEPTH = 3;
+    // frontier pruning margins in centipawns, indexed by remaining depth
+    const std::array<int, 4> REVERSE_FUTILITY_MARGINS = {0, 120, 240, 360}; // static eval this far above beta fails high
+    const std::array<int, 4> FUTILITY_MARGINS = {0, 150, 300, 450}; // quiet moves can't raise static eval this far below alpha
+    const std::array<int, 3> RAZORING_MARGINS = {0, 300, 550}; // only captures can save static eval this far below alpha
+    const int CURRMOVE_MIN_TIME = 1000; // milliseconds before root moves are reported, so short searches don't flood the GUI
+
+    // percent of the planned time to use, by how many iterations in a row returned the same best move
+    const std::array<int, 6> BEST_MOVE_STABILITY_SCALE = {150, 120, 100, 90, 80, 70};
+    const int MAX_SCORE_DROP_SCALE = 100; // extra percent of the planned time for a score drop, one per centipawn
 
     // used for outside UCI representation    
     struct Info {
-        uint64_t nodes;
-        int depth;
-        int eval;
+        uint64_t nodes = 0;
+        int depth = 0;
+        int eval = 0;
         int mateIn = NO_MATE;
-        BoardMove move;
-        uint64_t timeElapsed;
+        Move move;
+        Move ponderMove; // expected reply to move, null if unknown
+        uint64_t timeElapsed = 0;
+        int selDepth = 0; // deepest ply reached, including quiescence
+        int hashfull = 0; // permille of the transposition table used by this search
+        std::vector<Move> pv; // principal variation, starting with move
+        int multiPV = 1; // rank of this line among the best root moves
+    };
+
+    // Progress of the main search thread, every callback is optional.
+    // They are called from the search thread, so they must not block it for long.
+    struct Listener {
+        std::function<void(const Info&)> onIteration; // after every completed iteration
+        std::function<void(int depth, Move move, int moveNumber)> onCurrMove; // when the root starts searching a move
+        std::function<void(const Info&)> onFinish; // with the final result, once all threads stopped
     };
 
+    // what a go command asks for
+    struct Limits {
+        int time = Timeman::INF_TIME; // milliseconds left on our clock
+        int increment = 0;
+        int movesToGo = 0; // 0 if the rest of the game must be played in time
+        int moveTime = 0; // search exactly this many milliseconds, 0 if not given
+        uint64_t nodes = 0; // 0 for no limit
+        int depth = MAX_PLY - 1;
+        int mate = 0; // only look for a mate in this many moves, 0 for a normal search
+        bool infinite = false; // search until stopped
+        bool ponder = false;
+        int multiPV = 1; // number of best root moves to report, from the MultiPV option
+    };
+
+    // late move reductions by remaining depth and number of moves searched, filled by init
+    extern std::array<std::array<int, MAX_MOVES>, MAX_PLY> reductions;
+
     // used for internal searching
     struct Node {
-        int eval;
-        BoardMove move;
+        int eval = 0;
+        Move move;
     };
     
     class Searcher {
         public:  
-            Searcher(Board a_board, int ms, int depthLimit) {
+            Searcher(Board a_board, Limits a_limits, int a_threadId = 0, std::atomic<bool>* a_stop = nullptr,
+                     const std::atomic<bool>* a_pondering = nullptr, Listener a_listener = Listener()) {
                 this->board = a_board;
                 this->nodes = 0;
                 this->max_depth = 0;
-                this->tm = Timeman::TimeManager(ms);
-                this->depth_limit = depthLimit;
+                this->stopped = false;
+                this->nodesUntilStopCheck = STOP_CHECK_INTERVAL;
+                this->limits = a_limits;
+                this->tm = a_limits.infinite ? Timeman::TimeManager() :
+                           Timeman::TimeManager(a_limits.time, a_limits.increment, a_limits.movesToGo, a_limits.moveTime);
+                this->threadId = a_threadId;
+                this->stop = a_stop;
+                this->pondering = a_pondering;
+                this->listener = a_listener;
+                this->history = std::make_unique<History>();
             };
             Info startThinking();
             Node search(int alpha, int beta, int depthLeft, int distanceFromRoot);
-            int quiesce(int alpha, int beta, int depthLeft);
+            int quiesce(int alpha, int beta, int depthLeft, int distanceFromRoot);
+            uint64_t getNodes() const;
         private:
+            Node aspirationSearch(int depth, int previousEval);
+            bool isStopped();
+            bool softTimeUp(int bestMoveStability, int scoreDrop) const;
+            void updatePV(Move move, int distanceFromRoot);
+            void addStatistics(Info& info) const;
+            void storeKiller(Move move, int distanceFromRoot);
+            Move getPonderMove(Move bestMove);
+
             Board board;
-            uint64_t nodes;
+            std::atomic<uint64_t> nodes; // read by the main thread while helpers are searching
             int max_depth;
+            Limits limits;
             Timeman::TimeManager tm;
-            int depth_limit;
+            bool stopped; // once set, every node returns immediately
+            int nodesUntilStopCheck;
+            int threadId; // 0 is the main thread, whose result is reported
+            std::atomic<bool>* stop; // shared by every thread of a search
+            const std::atomic<bool>* pondering; // the clock doesn't run while searching on the opponent's time
+            std::array<std::array<Move, NUM_KILLERS>, MAX_PLY> killers = {}; // quiet moves that caused a beta cutoff at each ply
+            std::unique_ptr<History> history; // too large for the stack
+            // triangular PV table: pvTable[ply] holds the best line found from ply, which is pvLength[ply] moves long
+            std::array<std::array<Move, MAX_PLY + 1>, MAX_PLY + 1> pvTable;
+            std::array<int, MAX_PLY + 1> pvLength = {};
+            Listener listener; // only set for the main thread
+            int rootDepth = 0; // depth of the current iteration
+            int nullMoveMinPly = 0; // no null moves above this ply, while a null move cutoff is being verified
+            std::vector<Move> excludedRootMoves; // MultiPV: root moves whose line was already found this iteration
     };
+
+    // Lazy SMP: every thread searches a copy of the same root position with its own Searcher,
+    // and the threads only share work through the transposition table.
+    // Searches run on their own thread, so that the caller can keep reading commands and stop them.
+    class ThreadPool {
+        public:
+            ~ThreadPool();
+            void setThreads(int a_numThreads);
+            void startThinking(const Board& board, Limits limits, Listener listener);
+            void stopThinking();
+            void ponderhit();
+            void waitForThinking();
+        private:
+            Info think(const Board& board, Limits limits, const Listener& listener);
+
+            int numThreads = 1;
+            std::atomic<bool> stop{false};
+            std::atomic<bool> pondering{false};
+            std::thread mainThread;
+    };
+
+    void init();
+    int lateMovePruningCount(int depthLeft);
+
+    // Mate scores count plies from the root, so that shorter mates score better.
+    int mateIn(int ply); // score for mating the opponent on this ply
+    int matedIn(int ply); // score for being mated on this ply
+    bool isMateScore(int score);
+
+    // mate scores are stored relative to the node, since the same position can be reached at different plies
+    int scoreToTT(int score, int distanceFromRoot);
+    int scoreFromTT(int score, int distanceFromRoot);
 } // namespace Search
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "see.hpp"
+#include "attacks.hpp"
+#include "bitboard.hpp"
+#include "board.hpp"
+#include "move.hpp"
+#include "types.hpp"
+
+namespace SEE {
+    // Static exchange evaluation with a swap list: gains[i] is the material balance after the i-th capture, 
+    // assuming the exchange continues. Pieces are removed from allPieces as they capture, 
+    // so sliders lined up behind them are discovered as new attackers.
+    int evaluate(const Board& board, Move move) {
+        if (move.flag() == CastleMove) {
+            return 0;
+        }
+        int from = move.from();
+        int to = move.to();
+        uint64_t allPieces = board.pieceSets[WHITE_PIECES] | board.pieceSets[BLACK_PIECES];
+        uint64_t diagonals = board.pieceSets[WBishop] | board.pieceSets[BBishop] | board.pieceSets[WQueen] | board.pieceSets[BQueen];
+        uint64_t straights = board.pieceSets[WRook] | board.pieceSets[BRook] | board.pieceSets[WQueen] | board.pieceSets[BQueen];
+
+        std::array<int, 32> gains; // at most one capture per piece
+        pieceTypes attacker = board.getPiece(from);
+        int attackerValue = PIECE_VALUES[attacker % 6];
+        if (move.flag() == EnPassantMove) {
+            gains[0] = PIECE_VALUES[WPawn];
+            allPieces ^= 1ull << (board.isWhiteTurn ? to + 8 : to - 8);
+        }
+        else {
+            pieceTypes victim = board.getPiece(to);
+            gains[0] = victim == EmptyPiece ? 0 : PIECE_VALUES[victim % 6];
+        }
+        if (move.flag() == PromotionMove) {
+            attackerValue = PIECE_VALUES[move.promotionPiece(board.isWhiteTurn) % 6];
+            gains[0] += attackerValue - PIECE_VALUES[WPawn];
+        }
+
+        allPieces ^= 1ull << from;
+        uint64_t attackers = attackersTo(board, to, allPieces) & allPieces;
+        bool isWhite = !board.isWhiteTurn;
+        int depth = 0;
+        while (true) {
+            uint64_t sideAttackers = attackers & board.pieceSets[isWhite ? WHITE_PIECES : BLACK_PIECES];
+            if (!sideAttackers) {
+                break;
+            }
+
+            // least valuable attacker, searched from pawns up to the king
+            pieceTypes firstPiece = isWhite ? WKing : BKing;
+            int pieceType = WPawn;
+            uint64_t pieceAttackers = sideAttackers & board.pieceSets[firstPiece + WPawn];
+            for (int candidate: {WKnight, WBishop, WRook, WQueen, WKing}) {
+                if (pieceAttackers) {break;}
+                pieceType = candidate;
+                pieceAttackers = sideAttackers & board.pieceSets[firstPiece + candidate];
+            }
+
+            depth++;
+            gains[depth] = attackerValue - gains[depth - 1];
+            attackerValue = PIECE_VALUES[pieceType];
+
+            allPieces ^= 1ull << leadingBit(pieceAttackers);
+            if (pieceType == WPawn || pieceType == WBishop || pieceType == WQueen) {
+                attackers |= Attacks::bishopAttacks(to, allPieces) & diagonals;
+            }
+            if (pieceType == WRook || pieceType == WQueen) {
+                attackers |= Attacks::rookAttacks(to, allPieces) & straights;
+            }
+            attackers &= allPieces;
+            isWhite = !isWhite;
+        }
+
+        // each side may stop capturing instead of continuing a losing exchange
+        for (; depth > 0; depth--) {
+            gains[depth - 1] = -std::max(-gains[depth - 1], gains[depth]);
+        }
+        return gains[0];
+    }
+
+    // pieces of both colors that attack a square, allPieces is taken separately so that pieces can be seen through
+    uint64_t attackersTo(const Board& board, int square, uint64_t allPieces) {
+        uint64_t target = 1ull << square;
+        uint64_t diagonals = board.pieceSets[WBishop] | board.pieceSets[BBishop] | board.pieceSets[WQueen] | board.pieceSets[BQueen];
+        uint64_t straights = board.pieceSets[WRook] | board.pieceSets[BRook] | board.pieceSets[WQueen] | board.pieceSets[BQueen];
+
+        // a white pawn attacks the square if a black pawn on the square would attack the white pawn
+        return (pawnAttacks(target, false) & board.pieceSets[WPawn])
+             | (pawnAttacks(target, true) & board.pieceSets[BPawn])
+             | (knightSquares(target) & (board.pieceSets[WKnight] | board.pieceSets[BKnight]))
+             | (kingSquares(target) & (board.pieceSets[WKing] | board.pieceSets[BKing]))
+             | (Attacks::bishopAttacks(square, allPieces) & diagonals)
+             | (Attacks::rookAttacks(square, allPieces) & straights);
+    }
+} // namespace SEE
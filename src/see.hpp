@@ -0,0 +1,17 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "board.hpp"
+#include "move.hpp"
+#include "types.hpp"
+
+namespace SEE {
+    // indexed by pieceTypes % 6, the king is valued so that it is never traded
+    constexpr std::array<int, 6> PIECE_VALUES = {20000, 900, 300, 300, 500, 100};
+
+    // material won or lost by the moving side when both sides keep capturing on the target square with their least valuable piece
+    int evaluate(const Board& board, Move move);
+    uint64_t attackersTo(const Board& board, int square, uint64_t allPieces);
+} // namespace SEE
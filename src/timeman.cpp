@@ -1,14 +1,43 @@
 #include "timeman.hpp"
+#include <algorithm>
 #include <iostream>
 #include <cstdint>
 namespace Timeman {
+    // Splits the remaining time evenly over the moves left until the next time control,
+    // plus most of the increment, without ever planning to use more than most of what is on the clock.
+    TimeManager::TimeManager(int time, int increment, int movesToGo, int moveTime) {
+        this->startTime = std::chrono::steady_clock::now();
+        this->fixedTime = moveTime > 0 || time >= INF_TIME;
+        if (moveTime > 0) {
+            this->softLimit = this->hardLimit = uint64_t(std::max(moveTime - MOVE_OVERHEAD, 1)) * 1000;
+            return;
+        }
+        if (time >= INF_TIME) {
+            this->softLimit = this->hardLimit = uint64_t(INF_TIME) * 1000;
+            return;
+        }
+        int64_t movesLeft = movesToGo > 0 ? std::min(movesToGo, DEFAULT_MOVES_TO_GO) : DEFAULT_MOVES_TO_GO;
+        int64_t available = std::max(time - MOVE_OVERHEAD, 1);
+        int64_t budget = available / movesLeft + int64_t(increment) * 3 / 4;
+        int64_t maxTime = std::max(available * MAX_TIME_PERCENT / 100, int64_t(1));
+        this->softLimit = uint64_t(std::min(budget, maxTime)) * 1000;
+        this->hardLimit = uint64_t(std::min(budget * HARD_LIMIT_SCALE, maxTime)) * 1000;
+    }
+
     bool TimeManager::timeUp() const {
-        auto currTime = std::chrono::high_resolution_clock::now();
-        return std::chrono::duration_cast<std::chrono::microseconds>(currTime - startTime).count() > timeLimit;
+        auto currTime = std::chrono::steady_clock::now();
+        return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(currTime - startTime).count()) > this->hardLimit;
+    }
+
+    // percent scales the planned time, but never past the hard limit
+    bool TimeManager::softTimeUp(int percent) const {
+        uint64_t limit = this->fixedTime ? this->softLimit : std::min(this->softLimit * percent / 100, this->hardLimit);
+        auto currTime = std::chrono::steady_clock::now();
+        return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(currTime - startTime).count()) > limit;
     }
 
     uint64_t TimeManager::getTimeElapsed() const {
-        auto currTime = std::chrono::high_resolution_clock::now();
+        auto currTime = std::chrono::steady_clock::now();
         return std::chrono::duration_cast<std::chrono::milliseconds>(currTime - startTime).count();
     }
 } // namespace Timeman
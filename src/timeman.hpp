@@ -5,24 +5,32 @@
 
 namespace Timeman {
     const int INF_TIME = 1000000000;
+    const int MOVE_OVERHEAD = 20; // milliseconds kept back for communication with the GUI
+    const int DEFAULT_MOVES_TO_GO = 20; // moves expected until the next time control when the GUI doesn't say
+    const int HARD_LIMIT_SCALE = 3; // how far past the planned time an unstable search may run
+    const int MAX_TIME_PERCENT = 80; // share of the clock a single move may use, even with one move to go
 
+    // The soft limit is the time planned for this move, which search scales by how settled the result is
+    // and checks between iterations. The hard limit interrupts an iteration, whose result is then lost.
     struct TimeManager
     {
-        std::chrono::system_clock::time_point startTime; 
-        uint64_t timeLimit;
+        std::chrono::steady_clock::time_point startTime; // steady, so that clock adjustments don't affect the search
+        uint64_t softLimit; // microseconds
+        uint64_t hardLimit;
+        bool fixedTime; // movetime and infinite searches use exactly their limit
 
         // We need this for search.hpp to not die
         TimeManager() {
-            startTime = std::chrono::high_resolution_clock::now();
-            timeLimit = INF_TIME;
+            startTime = std::chrono::steady_clock::now();
+            softLimit = hardLimit = uint64_t(INF_TIME) * 1000;
+            fixedTime = true;
         }
 
-        TimeManager(int ms) {
-            startTime = std::chrono::high_resolution_clock::now();
-            timeLimit = ms * 1000 / 20;
-        }
+        // all times in milliseconds, time is INF_TIME and moveTime 0 when not given
+        TimeManager(int time, int increment, int movesToGo, int moveTime);
 
         bool timeUp() const;
+        bool softTimeUp(int percent) const;
         
         uint64_t getTimeElapsed() const;
     };
@@ -0,0 +1,149 @@
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "tt.hpp"
+#include "move.hpp"
+#include "types.hpp"
+
+namespace TT {
+    // global variables
+    Table table;
+
+    // Entry
+
+    Entry::Entry(uint64_t data) {
+        this->score = int32_t(data & 0xFFFFFFFFull);
+        this->move = (data >> 32) & 0xFFFF;
+        this->depth = (data >> 48) & 0xFF;
+        this->ageBound = data >> 56;
+    }
+
+    uint64_t Entry::toData() const {
+        return uint64_t(uint32_t(this->score)) | uint64_t(this->move) << 32 | 
+               uint64_t(this->depth) << 48 | uint64_t(this->ageBound) << 56;
+    }
+
+    Bound Entry::bound() const {
+        return Bound(this->ageBound & 0x3);
+    }
+
+    uint8_t Entry::age() const {
+        return this->ageBound >> 2;
+    }
+
+    Move Entry::getMove() const {
+        return Move(this->move);
+    }
+
+    // Table
+
+    Table::Table(int mb) {
+        this->age = 0;
+        this->resize(mb);
+    }
+
+    void Table::resize(int mb) {
+        size_t numBuckets = (size_t(mb) << 20) / sizeof(Bucket);
+        this->buckets = std::vector<Bucket>(numBuckets > 0 ? numBuckets : 1);
+    }
+
+    void Table::clear() {
+        this->age = 0;
+        for (Bucket& bucket: this->buckets) {
+            for (Slot& slot: bucket.slots) {
+                slot.keyXorData.store(0ull, std::memory_order_relaxed);
+                slot.data.store(0ull, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // entries from older searches are preferred for replacement
+    // must not be called while a search is running
+    void Table::newSearch() {
+        this->age = (this->age + 1) & 0x3F;
+    }
+
+    bool Table::probe(uint64_t key, Entry& result) const {
+        for (const Slot& slot: this->getBucket(key).slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if ((slot.keyXorData.load(std::memory_order_relaxed) ^ data) == key) {
+                result = Entry(data);
+                return result.bound() != NoBound;
+            }
+        }
+        return false;
+    }
+
+    // Depth-preferred replacement: an entry for the same position is overwritten, unless this search
+    // already stored a much deeper bound for it, which then only takes the newer best move.
+    // Otherwise the shallowest entry is replaced, with every search of age counting as 8 plies of depth.
+    void Table::store(uint64_t key, int depth, int score, Bound bound, Move move) {
+        Bucket& bucket = this->getBucket(key);
+        Slot* replace = &bucket.slots[0];
+        Entry replaceEntry;
+        int replaceWorth = INT32_MAX;
+        for (Slot& slot: bucket.slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            Entry entry(data);
+            if ((slot.keyXorData.load(std::memory_order_relaxed) ^ data) == key) {
+                if (entry.bound() != NoBound && entry.age() == this->age && bound != ExactBound &&
+                    depth < entry.depth - SAME_KEY_DEPTH_MARGIN) {
+                    if (!move.isNull()) {
+                        entry.move = move.data;
+                        data = entry.toData();
+                        slot.keyXorData.store(key ^ data, std::memory_order_relaxed);
+                        slot.data.store(data, std::memory_order_relaxed);
+                    }
+                    return;
+                }
+                replace = &slot;
+                replaceEntry = entry;
+                break;
+            }
+            int relativeAge = (this->age - entry.age()) & 0x3F;
+            int worth = entry.bound() == NoBound ? -1 : entry.depth - 8 * relativeAge;
+            if (worth < replaceWorth) {
+                replace = &slot;
+                replaceWorth = worth;
+            }
+        }
+
+        Entry newEntry;
+        newEntry.score = score;
+        newEntry.depth = depth;
+        newEntry.ageBound = (this->age << 2) | bound;
+        // keep the old best move if this search didn't find one
+        newEntry.move = move.data;
+        if (!newEntry.move && replaceEntry.bound() != NoBound) {
+            newEntry.move = replaceEntry.move;
+        }
+
+        uint64_t data = newEntry.toData();
+        replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+        replace->data.store(data, std::memory_order_relaxed);
+    }
+
+    // permille of the first slots written by the current search, which UCI reports as hashfull
+    int Table::hashfull() const {
+        int used = 0, sampled = 0;
+        for (size_t i = 0; i < this->buckets.size() && sampled < HASHFULL_SAMPLE; i++) {
+            for (const Slot& slot: this->buckets[i].slots) {
+                Entry entry(slot.data.load(std::memory_order_relaxed));
+                used += entry.bound() != NoBound && entry.age() == this->age;
+                sampled++;
+            }
+        }
+        return used * 1000 / sampled;
+    }
+
+    // multiplying by the bucket count and keeping the upper 64 bits maps keys evenly without a division
+    Bucket& Table::getBucket(uint64_t key) {
+        return this->buckets[(static_cast<__uint128_t>(key) * this->buckets.size()) >> 64];
+    }
+
+    const Bucket& Table::getBucket(uint64_t key) const {
+        return this->buckets[(static_cast<__uint128_t>(key) * this->buckets.size()) >> 64];
+    }
+
+} // namespace TT
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "move.hpp"
+#include "types.hpp"
+
+namespace TT {
+    const int DEFAULT_SIZE_MB = 16;
+    const int MAX_SIZE_MB = 4096;
+    const int BUCKET_SIZE = 4;
+    const int HASHFULL_SAMPLE = 1000; // slots checked to estimate how full the table is
+    const int SAME_KEY_DEPTH_MARGIN = 2; // a bound this much shallower than this search's entry for the position doesn't replace it
+
+    enum Bound : uint8_t {
+        NoBound = 0,
+        UpperBound = 1, // fail-low, true score <= stored score
+        LowerBound = 2, // fail-high, true score >= stored score
+        ExactBound = UpperBound | LowerBound,
+    };
+
+    // unpacked copy of the data held in a slot
+    struct Entry {
+        int32_t score = 0;
+        uint16_t move = 0;
+        uint8_t depth = 0;
+        uint8_t ageBound = NoBound; // upper 6 bits are the search age, lower 2 bits are the bound
+
+        Entry() = default;
+        Entry(uint64_t data);
+        uint64_t toData() const;
+        Bound bound() const;
+        uint8_t age() const;
+        Move getMove() const;
+    };
+
+    // Slots are written by every search thread without locking. The key is stored xor'ed with the data,
+    // so a slot torn by simultaneous writes fails the key check instead of returning another position's data.
+    struct Slot {
+        std::atomic<uint64_t> keyXorData{0ull};
+        std::atomic<uint64_t> data{0ull};
+    };
+
+    // 16 bytes per slot, so a bucket of 4 fills exactly one 64 byte cache line
+    struct alignas(64) Bucket {
+        std::array<Slot, BUCKET_SIZE> slots;
+    };
+
+    class Table {
+        public:
+            Table(int mb = DEFAULT_SIZE_MB);
+            void resize(int mb);
+            void clear();
+            void newSearch();
+            bool probe(uint64_t key, Entry& result) const;
+            void store(uint64_t key, int depth, int score, Bound bound, Move move);
+            int hashfull() const;
+        private:
+            Bucket& getBucket(uint64_t key);
+            const Bucket& getBucket(uint64_t key) const;
+
+            std::vector<Bucket> buckets;
+            uint8_t age;
+    };
+
+    // shared between every search
+    extern Table table;
+} // namespace TT
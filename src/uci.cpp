@@ -2,16 +2,21 @@
 #include <string>
 #include <sstream>
 #include <stdexcept>
+#include <algorithm>
 #include <chrono>
+#include <mutex>
 
 #include "uci.hpp"
 #include "timeman.hpp"
 #include "search.hpp"
 #include "moveGen.hpp"
 #include "board.hpp"
+#include "tt.hpp"
 
 namespace Uci {
     UciOptions OPTIONS;
+    Search::ThreadPool THREADS;
+    std::mutex OUTPUT_MUTEX; // the search thread reports while the UCI thread answers commands
 
     bool uci() {
         std::string input;
@@ -24,16 +29,19 @@ namespace Uci {
         std::cout << "id author BlockyTeam\n";
 
         std::cout << "option name maxDepth type spin default 100 min 1 max 200\n";
+        std::cout << "option name Hash type spin default " << TT::DEFAULT_SIZE_MB << " min 1 max " << TT::MAX_SIZE_MB << "\n";
+        std::cout << "option name Threads type spin default 1 min 1 max " << MAX_THREADS << "\n";
+        std::cout << "option name MultiPV type spin default 1 min 1 max " << MAX_MOVES << "\n";
 
         std::cout << "uciok\n";
         return true;
     }
 
     void setOptionLoop() {
-        std::string commandLine, commandToken;
-        while (true) {
-            std::getline(std::cin, commandLine);
+        std::string commandLine;
+        while (std::getline(std::cin, commandLine)) {
             std::istringstream commandStream(commandLine);
+            std::string commandToken;
             commandStream >> commandToken;
 
             if (commandToken == "setoption") {setOption(commandStream);}
@@ -49,30 +57,76 @@ namespace Uci {
         if (token == "maxDepth") {
             input >> token;
             input >> token;
-            OPTIONS.depth = std::stoi(token);
+            // deeper searches can't be stored in the transposition table
+            OPTIONS.depth = std::min(std::max(std::stoi(token), 1), Search::MAX_PLY - 1);
             std::cout << "Depth set to: " << OPTIONS.depth << std::endl;
-        };
+        }
+        else if (token == "Hash") {
+            input >> token;
+            input >> token;
+            OPTIONS.hashSize = std::min(std::max(std::stoi(token), 1), TT::MAX_SIZE_MB);
+            TT::table.resize(OPTIONS.hashSize);
+            std::cout << "Hash set to: " << OPTIONS.hashSize << " MB" << std::endl;
+        }
+        else if (token == "Threads") {
+            input >> token;
+            input >> token;
+            OPTIONS.threads = std::min(std::max(std::stoi(token), 1), MAX_THREADS);
+            THREADS.setThreads(OPTIONS.threads);
+            std::cout << "Threads set to: " << OPTIONS.threads << std::endl;
+        }
+        else if (token == "MultiPV") {
+            input >> token;
+            input >> token;
+            OPTIONS.multiPV = std::min(std::max(std::stoi(token), 1), MAX_MOVES);
+            std::cout << "MultiPV set to: " << OPTIONS.multiPV << std::endl;
+        }
     }
 
 
     void uciLoop() {
-        std::string commandLine, commandToken;
+        std::string commandLine;
         Board currBoard;
         while (true) {
-            std::getline(std::cin, commandLine);
+            // a closed input lets the current search finish, then quits
+            if (!std::getline(std::cin, commandLine)) {
+                THREADS.waitForThinking();
+                return;
+            }
             std::istringstream commandStream(commandLine);
+            std::string commandToken;
             commandStream >> commandToken;
 
-            if (commandToken == "ucinewgame") {}
+            // these are answered while searching
+            if (commandToken == "isready") {isready(); continue;}
+            else if (commandToken == "stop") {THREADS.stopThinking(); continue;}
+            else if (commandToken == "ponderhit") {THREADS.ponderhit(); continue;}
+            else if (commandToken == "quit") {
+                THREADS.stopThinking();
+                THREADS.waitForThinking();
+                return;
+            }
+            // debug, empty lines and unknown commands are ignored without waiting,
+            // or a search that only ends on stop would never read the stop
+            if (!waitsForSearch(commandToken)) {continue;}
+            THREADS.waitForThinking();
+
+            if (commandToken == "ucinewgame") {TT::table.clear();}
+            else if (commandToken == "setoption") {setOption(commandStream);}
             else if (commandToken == "position") {currBoard = position(commandStream);}
             else if (commandToken == "go") {Uci::go(commandStream, currBoard);}
-            else if (commandToken == "isready") {isready();}
             else if (commandToken == "perft") {perft(commandStream, currBoard);}
-            else if (commandToken == "quit") {return;}
+            else if (commandToken == "perftbench") {perftBench();}
+            else if (commandToken == "bench") {bench();}
         }
     }
 
 
+    // commands that change the position, options or table the search uses, which wait for it to finish
+    bool waitsForSearch(const std::string& command) {
+        return std::find(STATE_COMMANDS.begin(), STATE_COMMANDS.end(), command) != STATE_COMMANDS.end();
+    }
+
     Board position(std::istringstream& input) {
         std::string token;
         Board currBoard;
@@ -107,45 +161,87 @@ namespace Uci {
     }
 
     void go(std::istringstream& input, Board& board) {
-        std::string token;
-        int wtime = Timeman::INF_TIME, btime = Timeman::INF_TIME, allytime;
+        Search::Limits limits;
+        limits.depth = OPTIONS.depth;
+        limits.multiPV = OPTIONS.multiPV;
         std::string param, value;
         while (input >> param) {
+            // flags without a value
+            if (param == "ponder") {limits.ponder = true; continue;}
+            if (param == "infinite") {limits.infinite = true; continue;}
+
             input >> value;
-            if (param == "wtime") {wtime = std::stoi(value);}
-            else if (param == "btime") {btime = std::stoi(value);}
+            if ((param == "wtime" && board.isWhiteTurn) || (param == "btime" && !board.isWhiteTurn)) {limits.time = std::stoi(value);}
+            else if ((param == "winc" && board.isWhiteTurn) || (param == "binc" && !board.isWhiteTurn)) {limits.increment = std::stoi(value);}
+            else if (param == "movestogo") {limits.movesToGo = std::stoi(value);}
+            else if (param == "movetime") {limits.moveTime = std::stoi(value);}
+            else if (param == "nodes") {limits.nodes = std::stoull(value);}
+            else if (param == "depth") {limits.depth = std::min(std::max(std::stoi(value), 1), Search::MAX_PLY - 1);}
+            else if (param == "mate") {limits.mate = std::stoi(value);}
         }   
-        allytime = board.isWhiteTurn ? wtime : btime;
 
-        Search::Searcher currSearch(board, allytime, OPTIONS.depth);
-        Search::Info result = currSearch.startThinking();
-        
-        info(result);
-        std::cout << "bestmove " << result.move.toStr() << "\n";
+        Search::Listener listener;
+        listener.onIteration = [](const Search::Info& result) {
+            info(result);
+        };
+        listener.onCurrMove = [](int depth, Move move, int moveNumber) {
+            std::ostringstream line;
+            line << "info depth " << depth << " currmove " << move.toStr() << " currmovenumber " << moveNumber;
+            sendLine(line.str());
+        };
+        // every completed iteration was already reported
+        listener.onFinish = [mate = limits.mate](const Search::Info& result) {
+            // go mate only reports iterations that found the mate, so without one nothing was said yet
+            if (mate > 0 && result.eval < Search::mateIn(2 * mate - 1)) {
+                sendLine("info string no mate in " + std::to_string(mate) + " found");
+            }
+            std::ostringstream line;
+            line << "bestmove " << result.move.toStr();
+            if (!result.ponderMove.isNull()) {
+                line << " ponder " << result.ponderMove.toStr();
+            }
+            sendLine(line.str());
+        };
+        THREADS.startThinking(board, limits, listener);
     }
 
     void info(Search::Info searchResult) {
-        std::cout << "info depth " << searchResult.depth << ' ';
-        std::cout << "nodes " << searchResult.nodes << ' ';
-
-        // time is output in milliseconds per the UCI protocol
-        std::cout << "time " << searchResult.timeElapsed << ' ';
-        if (searchResult.timeElapsed > 0) { // prevents divide by 0
-            std::cout << "nps " << searchResult.nodes * 1000 / searchResult.timeElapsed  << ' ';
-        }
-        
-        
+        std::ostringstream line;
+        line << "info depth " << searchResult.depth << ' ';
+        line << "seldepth " << searchResult.selDepth << ' ';
+        line << "multipv " << searchResult.multiPV << ' ';
         if (searchResult.mateIn == Search::NO_MATE) {
-            std::cout << "score cp " << searchResult.eval << ' ';
+            line << "score cp " << searchResult.eval << ' ';
         }
         else { 
-            std::cout << "mate " << (searchResult.mateIn + 1) / 2 << ' '; // convert plies to moves
+            // convert plies to moves, negative when we are the one getting mated, and 0 when we already are
+            int mateMoves = (searchResult.mateIn + 1) / 2;
+            line << "score mate " << (searchResult.eval < 0 && mateMoves > 0 ? "-" : "") << mateMoves << ' ';
+        }
+        line << "nodes " << searchResult.nodes << ' ';
+        if (searchResult.timeElapsed > 0) { // prevents divide by 0
+            line << "nps " << searchResult.nodes * 1000 / searchResult.timeElapsed  << ' ';
+        }
+        // time is output in milliseconds per the UCI protocol
+        line << "time " << searchResult.timeElapsed << ' ';
+        line << "hashfull " << searchResult.hashfull;
+        if (!searchResult.pv.empty()) {
+            line << " pv";
+            for (Move move: searchResult.pv) {
+                line << ' ' << move.toStr();
+            }
         }
-        std::cout << '\n';
+        sendLine(line.str());
     }
 
     void isready() {
-        std::cout << "readyok\n";
+        sendLine("readyok");
+    }
+
+    // whole lines are written at once, so that lines from different threads never interleave
+    void sendLine(const std::string& line) {
+        std::lock_guard<std::mutex> lock(OUTPUT_MUTEX);
+        std::cout << line << std::endl;
     }
 
     void perft(std::istringstream& input, Board& board) {
@@ -174,5 +270,42 @@ namespace Uci {
         std::cout << " time " << duration / 1000 << "\n";
 
     }
-} // namespace Uci
 
+    // measures move generation speed over a fixed set of positions
+    void perftBench() {
+        uint64_t totalNodes = 0;
+        int64_t totalDuration = 0;
+        for (const BenchPosition& position: PERFT_BENCH_POSITIONS) {
+            Board board(position.fen);
+            auto start = std::chrono::high_resolution_clock::now();
+            uint64_t nodes = MOVEGEN::perftHelper(board, position.depth);
+            auto end = std::chrono::high_resolution_clock::now();
+            int64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+            totalNodes += nodes;
+            totalDuration += duration;
+            std::cout << "perft depth " << position.depth << " nodes " << nodes << " time " << duration / 1000 << " fen " << position.fen << "\n";
+        }
+        std::cout << "perftbench result nodes " << totalNodes;
+        std::cout << " nps " << totalNodes * 1000000 / totalDuration;
+        std::cout << " time " << totalDuration / 1000 << std::endl;
+    }
+
+    // measures search speed over a fixed set of positions, each searched to a fixed depth from an empty hash table
+    void bench() {
+        uint64_t totalNodes = 0;
+        uint64_t totalTime = 0;
+        for (const BenchPosition& position: SEARCH_BENCH_POSITIONS) {
+            TT::table.clear();
+            Search::Limits limits;
+            limits.depth = position.depth;
+            Search::Searcher searcher(Board(position.fen), limits);
+            Search::Info result = searcher.startThinking();
+            totalNodes += result.nodes;
+            totalTime += result.timeElapsed;
+            std::cout << "bench depth " << position.depth << " nodes " << result.nodes << " time " << result.timeElapsed << " fen " << position.fen << "\n";
+        }
+        std::cout << "bench result nodes " << totalNodes;
+        std::cout << " nps " << totalNodes * 1000 / std::max(totalTime, uint64_t(1));
+        std::cout << " time " << totalTime << std::endl;
+    }
+} // namespace Uci
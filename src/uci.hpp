@@ -1,14 +1,48 @@
 #pragma once
 
+#include <array>
 #include <string>
 #include <sstream>
 
 #include "board.hpp"
 #include "search.hpp"
+#include "tt.hpp"
 
 namespace Uci {
+    const int MAX_THREADS = 256;
+
+    struct BenchPosition {
+        std::string fen;
+        int depth;
+    };
+
+    // well known perft positions covering castling, en passant, promotions and pins
+    const std::array<BenchPosition, 5> PERFT_BENCH_POSITIONS {{
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5},
+        {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4},
+        {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5},
+        {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4},
+        {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4},
+    }};
+
+    // tactical middlegames, where most of the search is spent in quiescence
+    const std::array<BenchPosition, 5> SEARCH_BENCH_POSITIONS {{
+        {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 6},
+        {"2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1", 6},
+        {"r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4", 6},
+        {"r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", 6},
+        {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 6},
+    }};
+
+    const std::array<std::string, 7> STATE_COMMANDS = {
+        "ucinewgame", "setoption", "position", "go", "perft", "perftbench", "bench",
+    };
+
     struct UciOptions {
         int depth = 100;
+        int hashSize = TT::DEFAULT_SIZE_MB;
+        int threads = 1;
+        int multiPV = 1;
     };
 
     bool uci();
@@ -17,13 +51,17 @@ namespace Uci {
     void setOption(std::istringstream& input);
 
     void uciLoop();
+    bool waitsForSearch(const std::string& command);
     Board position(std::istringstream& input);
     void go(std::istringstream& input, Board& board);
     void info(Search::Info searchResult);
 
     void isready();
+    void sendLine(const std::string& line);
 
     // for debugging
     void perft(std::istringstream& input, Board& board);
+    void perftBench();
+    void bench();
 
 } // namespace Uci
@@ -333,4 +333,21 @@ TEST(BitboardTest, kingAttackersFalse) {
     uint64_t enemies = arrayToBitboardNotEmpty(enemiesBoard);
 
     EXPECT_EQ(kingAttackers(square, enemies), false);
-}
\ No newline at end of file
+}
+TEST(BitboardTest, kingSquaresCorner) {
+    EXPECT_EQ(kingSquares(1ull), 0x0000000000000302ull);
+}
+
+TEST(BitboardTest, kingSquaresEdge) {
+    EXPECT_EQ(kingSquares(1ull << 39), 0x0000C040C0000000ull);
+}
+
+TEST(BitboardTest, pawnAttacksWhite) {
+    uint64_t pawns = 1ull << 48 | 1ull << 52;
+    EXPECT_EQ(pawnAttacks(pawns, true), 0x00002A0000000000ull);
+}
+
+TEST(BitboardTest, pawnAttacksBlack) {
+    uint64_t pawns = 1ull << 15;
+    EXPECT_EQ(pawnAttacks(pawns, false), 0x0000000000400000ull);
+}
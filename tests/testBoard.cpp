@@ -733,7 +733,9 @@ TEST_F(BoardTest, BoardMoveConstructorRookPin) {
     BoardSquare pos1 = BoardSquare(1, A);
     BoardSquare pos2 = BoardSquare(1, B);
     board.makeMove(pos1, pos2);
-    ASSERT_EQ(board.isIllegalPos, true);
+    // the king of the side that moved is left in check
+    board.isWhiteTurn = !board.isWhiteTurn;
+    ASSERT_EQ(currKingInAttack(board), true);
 }
 
 TEST_F(BoardTest, BoardMoveConstructorBishopPin) {
@@ -751,7 +753,9 @@ TEST_F(BoardTest, BoardMoveConstructorBishopPin) {
     BoardSquare pos1 = BoardSquare(6, B);
     BoardSquare pos2 = BoardSquare(5, A);
     board.makeMove(pos1, pos2);
-    ASSERT_EQ(board.isIllegalPos, true);
+    // the king of the side that moved is left in check
+    board.isWhiteTurn = !board.isWhiteTurn;
+    ASSERT_EQ(currKingInAttack(board), true);
 }
 
 TEST_F(BoardTest, BoardMoveConstructorCastleRightsRook) {
@@ -938,4 +942,96 @@ TEST(MoveIsCaptureTest, defaultBoard) {
     EXPECT_EQ(b_12, true);
     EXPECT_EQ(b_13, false);
     EXPECT_EQ(b_14, true);
-}
\ No newline at end of file
+}
+TEST_F(BoardTest, isRepetitionThreefold) {
+    Board board;
+    std::array<std::string, 4> shuffle = {"g1f3", "g8f6", "f3g1", "f6g8"};
+    for (std::string move: shuffle) {
+        board.makeMove(BoardMove(move, board.isWhiteTurn));
+    }
+    EXPECT_EQ(board.isRepetition(), false);
+    for (std::string move: shuffle) {
+        board.makeMove(BoardMove(move, board.isWhiteTurn));
+    }
+    EXPECT_EQ(board.isRepetition(), true);
+}
+
+TEST_F(BoardTest, isRepetitionInSearch) {
+    Board board;
+    std::array<std::string, 4> shuffle = {"g1f3", "g8f6", "f3g1", "f6g8"};
+    for (std::string move: shuffle) {
+        board.makeMove(BoardMove(move, board.isWhiteTurn));
+    }
+    EXPECT_EQ(board.isRepetition(4), false);
+    EXPECT_EQ(board.isRepetition(5), true);
+}
+
+TEST_F(BoardTest, isRepetitionPawnMove) {
+    Board board;
+    std::array<std::string, 6> moves = {"g1f3", "g8f6", "f3g1", "f6g8", "e2e4", "e7e5"};
+    for (std::string move: moves) {
+        board.makeMove(BoardMove(move, board.isWhiteTurn));
+    }
+    std::array<std::string, 4> shuffle = {"g1f3", "g8f6", "f3g1", "f6g8"};
+    for (std::string move: shuffle) {
+        board.makeMove(BoardMove(move, board.isWhiteTurn));
+    }
+    EXPECT_EQ(board.isRepetition(), false);
+}
+
+TEST_F(BoardTest, nullMove) {
+    Board board("rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e6 0 2");
+    Board original = board;
+    board.makeNullMove();
+    EXPECT_EQ(board.isWhiteTurn, false);
+    EXPECT_EQ(board.pawnJumpedSquare, BoardSquare());
+    EXPECT_EQ(board.zobristKeyHistory.back(), board.zobristKey);
+
+    // the same position reached by moving has the same key
+    Board noEnPassant("rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2");
+    EXPECT_EQ(board.zobristKey, noEnPassant.zobristKey);
+
+    board.undoNullMove();
+    EXPECT_EQ(board.isWhiteTurn, original.isWhiteTurn);
+    EXPECT_EQ(board.pawnJumpedSquare, original.pawnJumpedSquare);
+    EXPECT_EQ(board.fiftyMoveRule, original.fiftyMoveRule);
+    EXPECT_EQ(board.zobristKey, original.zobristKey);
+    EXPECT_EQ(board.zobristKeyHistory, original.zobristKeyHistory);
+}
+
+TEST_F(BoardTest, hasNonPawnMaterial) {
+    EXPECT_EQ(Board("4k3/4p3/8/8/8/8/4P3/4K3 w - - 0 1").hasNonPawnMaterial(), false);
+    EXPECT_EQ(Board("4k3/4p3/8/8/8/8/4P3/4K1N1 w - - 0 1").hasNonPawnMaterial(), true);
+    EXPECT_EQ(Board("4k3/4p3/8/8/8/8/4P3/4K1N1 b - - 0 1").hasNonPawnMaterial(), false);
+}
+
+TEST_F(BoardTest, isInCheck) {
+    Board board("rnbqkbnr/ppppp2p/5p2/6p1/4P3/8/PPPP1PPP/RNBQKBNR w KQkq g6 0 3");
+    EXPECT_EQ(board.isInCheck, false);
+    board.makeMove(BoardMove("d1h5", board.isWhiteTurn));
+    EXPECT_EQ(board.isInCheck, true);
+    board.undoMove();
+    EXPECT_EQ(board.isInCheck, false);
+
+    EXPECT_EQ(Board("rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3").isInCheck, true);
+}
+
+TEST_F(BoardTest, givesCheck) {
+    Board board("r3k2r/8/8/8/1b6/8/3B4/R3K1NR w KQkq - 0 1");
+    EXPECT_EQ(board.givesCheck(board.toMove(BoardMove("a1a8", board.isWhiteTurn))), true);   // direct
+    EXPECT_EQ(board.givesCheck(board.toMove(BoardMove("g1f3", board.isWhiteTurn))), false);
+    EXPECT_EQ(board.givesCheck(board.toMove(BoardMove("d2b4", board.isWhiteTurn))), false);
+
+    Board discovered("4k3/8/8/8/4N3/8/8/4RK2 w - - 0 1");
+    EXPECT_EQ(discovered.givesCheck(discovered.toMove(BoardMove("e4c3", discovered.isWhiteTurn))), true);
+
+    Board castle("5k2/8/8/8/8/8/8/4K2R w K - 0 1");
+    EXPECT_EQ(castle.givesCheck(castle.toMove(BoardMove("e1g1", castle.isWhiteTurn))), true);
+
+    Board enPassant("8/8/8/k2Pp2R/8/8/8/4K3 w - e6 0 1");
+    EXPECT_EQ(enPassant.givesCheck(enPassant.toMove(BoardMove("d5e6", enPassant.isWhiteTurn))), true);
+
+    Board promotion("3k4/4P3/8/8/8/8/8/4K3 w - - 0 1");
+    EXPECT_EQ(promotion.givesCheck(promotion.toMove(BoardMove("e7e8q", promotion.isWhiteTurn))), true);
+    EXPECT_EQ(promotion.givesCheck(promotion.toMove(BoardMove("e7e8n", promotion.isWhiteTurn))), false);
+}
@@ -0,0 +1,62 @@
+#include "board.hpp"
+#include "history.hpp"
+#include "attacks.hpp"
+#include "zobrist.hpp"
+
+#include <memory>
+
+#include <gtest/gtest.h>
+
+class HistoryTest : public testing::Test {
+    public:
+        static void SetUpTestSuite() {
+            Zobrist::init();
+            Attacks::init();
+        }
+};
+
+TEST_F(HistoryTest, cutoffRaisesBestAndLowersTried) {
+    std::unique_ptr<History> history = std::make_unique<History>();
+    Board board;
+    board.makeMove(BoardMove("e2e4", board.isWhiteTurn));
+    Move tried = board.toMove(BoardMove("a7a6", board.isWhiteTurn));
+    Move best = board.toMove(BoardMove("e7e5", board.isWhiteTurn));
+    MoveList quietsTried;
+    quietsTried.push_back(tried);
+    quietsTried.push_back(best);
+
+    history->update(board, best, quietsTried, 4);
+    EXPECT_GT(history->getQuietScore(board, best), 0);
+    EXPECT_LT(history->getQuietScore(board, tried), 0);
+}
+
+TEST_F(HistoryTest, counterMove) {
+    std::unique_ptr<History> history = std::make_unique<History>();
+    Board board;
+    EXPECT_TRUE(history->getCounterMove(board).isNull());
+
+    board.makeMove(BoardMove("e2e4", board.isWhiteTurn));
+    Move best = board.toMove(BoardMove("e7e5", board.isWhiteTurn));
+    MoveList quietsTried;
+    quietsTried.push_back(best);
+    history->update(board, best, quietsTried, 4);
+    EXPECT_EQ(history->getCounterMove(board), best);
+
+    // the same reply is suggested after the same move in another position
+    Board other("rnbqkbnr/pppppppp/8/8/8/5N2/PPPPPPPP/RNBQKB1R w KQkq - 1 1");
+    other.makeMove(BoardMove("e2e4", other.isWhiteTurn));
+    EXPECT_EQ(history->getCounterMove(other), best);
+}
+
+TEST_F(HistoryTest, scoresStayBounded) {
+    std::unique_ptr<History> history = std::make_unique<History>();
+    Board board;
+    Move best = board.toMove(BoardMove("e2e4", board.isWhiteTurn));
+    MoveList quietsTried;
+    quietsTried.push_back(best);
+    for (int i = 0; i < 1000; i++) {
+        history->update(board, best, quietsTried, 20);
+    }
+    EXPECT_LE(history->getQuietScore(board, best), MAX_HISTORY);
+    EXPECT_GT(history->getQuietScore(board, best), MAX_HISTORY / 2);
+}
@@ -7,8 +7,21 @@
 #include <gtest/gtest.h>
 #include <vector>
 #include <algorithm>
+#include <string>
 
 using namespace MOVEGEN;
+
+// MoveList has no order, so tests compare sorted vectors of its moves
+static std::vector<BoardMove> sortedMoves(const Board& board, const MoveList& moveList) {
+    std::vector<BoardMove> moves;
+    for (const ScoredMove& scoredMove: moveList) {
+        Move move = scoredMove.move;
+        moves.push_back(BoardMove(BoardSquare(move.from()), BoardSquare(move.to()), move.promotionPiece(board.isWhiteTurn)));
+    }
+    std::sort(moves.begin(), moves.end());
+    return moves;
+}
+
 class MoveGenTest : public testing::Test {
     public:
         static void SetUpTestSuite() {
@@ -54,7 +67,7 @@ TEST_F(MoveGenTest, validPawnMovesCaptures) {
     };
     Board board(boardArr);
     
-    std::vector<BoardMove> validMoves;
+    MoveList moveList;
     std::vector<BoardMove> expectedValidMoves = {
         BoardMove(BoardSquare(4, B), BoardSquare(3, A)),
         BoardMove(BoardSquare(4, B), BoardSquare(3, B)),
@@ -67,9 +80,9 @@ TEST_F(MoveGenTest, validPawnMovesCaptures) {
         BoardMove(BoardSquare(6, G), BoardSquare(4, G)),
     };
     uint64_t whitePawns = arrayToBitboardPieceType(boardArr, WPawn);
-    validPawnMoves(board, validMoves, whitePawns);
+    validPawnMoves(board, LegalityInfo(board), moveList, whitePawns);
 
-    std::sort(validMoves.begin(), validMoves.end());
+    std::vector<BoardMove> validMoves = sortedMoves(board, moveList);
     std::sort(expectedValidMoves.begin(), expectedValidMoves.end());
     ASSERT_EQ(validMoves, expectedValidMoves);
 }
@@ -87,7 +100,7 @@ TEST_F(MoveGenTest, validPawnMovesPromotion) {
     };
     Board board(boardArr);
     
-    std::vector<BoardMove> validMoves;
+    MoveList moveList;
     std::vector<BoardMove> expectedValidMoves = {
         BoardMove(BoardSquare(1, D), BoardSquare(0, D), WKnight),
         BoardMove(BoardSquare(1, D), BoardSquare(0, D), WBishop),
@@ -95,9 +108,9 @@ TEST_F(MoveGenTest, validPawnMovesPromotion) {
         BoardMove(BoardSquare(1, D), BoardSquare(0, D), WQueen),
     };
     uint64_t whitePawns = arrayToBitboardPieceType(boardArr, WPawn);
-    validPawnMoves(board, validMoves, whitePawns);
+    validPawnMoves(board, LegalityInfo(board), moveList, whitePawns);
 
-    std::sort(validMoves.begin(), validMoves.end());
+    std::vector<BoardMove> validMoves = sortedMoves(board, moveList);
     std::sort(expectedValidMoves.begin(), expectedValidMoves.end());
     ASSERT_EQ(validMoves, expectedValidMoves);
 }
@@ -115,7 +128,7 @@ TEST_F(MoveGenTest, validKnightMoves1) {
     };
     Board board(boardArr);
     
-    std::vector<BoardMove> validMoves;
+    MoveList moveList;
     std::vector<BoardMove> expectedValidMoves = {
         BoardMove(BoardSquare(7, A), BoardSquare(5, B)),
         BoardMove(BoardSquare(7, A), BoardSquare(6, C)),
@@ -130,9 +143,9 @@ TEST_F(MoveGenTest, validKnightMoves1) {
         BoardMove(BoardSquare(4, D), BoardSquare(3, B)),
     };
     uint64_t whiteKnights = arrayToBitboardPieceType(boardArr, WKnight);
-    validKnightMoves(board, validMoves, whiteKnights);
+    validKnightMoves(board, LegalityInfo(board), moveList, whiteKnights);
 
-    std::sort(validMoves.begin(), validMoves.end());
+    std::vector<BoardMove> validMoves = sortedMoves(board, moveList);
     std::sort(expectedValidMoves.begin(), expectedValidMoves.end());
     ASSERT_EQ(validMoves, expectedValidMoves);
 }
@@ -150,7 +163,7 @@ TEST_F(MoveGenTest, validRookMoves1) {
     };
     Board board(boardArr, true);
     
-    std::vector<BoardMove> validMoves;
+    MoveList moveList;
     std::vector<BoardMove> expectedValidMoves;
     for (int rank = 6; rank >= 1; rank--) {
         expectedValidMoves.push_back(BoardMove(BoardSquare(7, A), BoardSquare(rank, A)));
@@ -160,9 +173,9 @@ TEST_F(MoveGenTest, validRookMoves1) {
         expectedValidMoves.push_back(BoardMove(BoardSquare(7, B), BoardSquare(7, file)));
     }
     uint64_t whiteRooks = arrayToBitboardPieceType(boardArr, WRook);
-    validRookMoves(board, validMoves, whiteRooks);
+    validRookMoves(board, LegalityInfo(board), moveList, whiteRooks);
 
-    std::sort(validMoves.begin(), validMoves.end());
+    std::vector<BoardMove> validMoves = sortedMoves(board, moveList);
     std::sort(expectedValidMoves.begin(), expectedValidMoves.end());
     ASSERT_EQ(validMoves, expectedValidMoves);
 }
@@ -180,7 +193,7 @@ TEST_F(MoveGenTest, validBishopMoves1) {
     };
     Board board(boardArr);
     
-    std::vector<BoardMove> validMoves;
+    MoveList moveList;
     std::vector<BoardMove> expectedValidMoves = {
         BoardMove(BoardSquare(7, A), BoardSquare(6, B)),
         BoardMove(BoardSquare(7, A), BoardSquare(5, C)),
@@ -200,9 +213,9 @@ TEST_F(MoveGenTest, validBishopMoves1) {
         BoardMove(BoardSquare(4, D), BoardSquare(2, F)),
     };
     uint64_t whiteBishops = arrayToBitboardPieceType(boardArr, WBishop);
-    validBishopMoves(board, validMoves, whiteBishops);
+    validBishopMoves(board, LegalityInfo(board), moveList, whiteBishops);
 
-    std::sort(validMoves.begin(), validMoves.end());
+    std::vector<BoardMove> validMoves = sortedMoves(board, moveList);
     std::sort(expectedValidMoves.begin(), expectedValidMoves.end());
     ASSERT_EQ(validMoves, expectedValidMoves);
 }
@@ -220,7 +233,7 @@ TEST_F(MoveGenTest, validQueenMoves1) {
     };
     Board board(boardArr);
     
-    std::vector<BoardMove> validMoves;
+    MoveList moveList;
     std::vector<BoardMove> expectedValidMoves;
     for (int i = 1; i <= 7; i++) {
         expectedValidMoves.push_back(BoardMove(BoardSquare(7, A), BoardSquare(7 - i, A)));
@@ -234,9 +247,9 @@ TEST_F(MoveGenTest, validQueenMoves1) {
         expectedValidMoves.push_back(BoardMove(BoardSquare(7, H), BoardSquare(7, H - i)));
     }
     uint64_t whiteQueens = arrayToBitboardPieceType(boardArr, WQueen);
-    validQueenMoves(board, validMoves, whiteQueens);
+    validQueenMoves(board, LegalityInfo(board), moveList, whiteQueens);
 
-    std::sort(validMoves.begin(), validMoves.end());
+    std::vector<BoardMove> validMoves = sortedMoves(board, moveList);
     std::sort(expectedValidMoves.begin(), expectedValidMoves.end());
     ASSERT_EQ(validMoves, expectedValidMoves);
 }
@@ -254,7 +267,7 @@ TEST_F(MoveGenTest, validKingMovesNoCastle) {
     };
     Board board(boardArr);
     
-    std::vector<BoardMove> validMoves;
+    MoveList moveList;
     std::vector<BoardMove> expectedValidMoves = {
         BoardMove(BoardSquare(7, A), BoardSquare(6, A)),
         BoardMove(BoardSquare(7, A), BoardSquare(6, B)),
@@ -270,9 +283,9 @@ TEST_F(MoveGenTest, validKingMovesNoCastle) {
         BoardMove(BoardSquare(4, D), BoardSquare(4, C)),
     };
     uint64_t whiteKings = arrayToBitboardPieceType(boardArr, WKing);
-    validKingMoves(board, validMoves, whiteKings);
+    validKingMoves(board, LegalityInfo(board), moveList, whiteKings);
 
-    std::sort(validMoves.begin(), validMoves.end());
+    std::vector<BoardMove> validMoves = sortedMoves(board, moveList);
     std::sort(expectedValidMoves.begin(), expectedValidMoves.end());
     ASSERT_EQ(validMoves, expectedValidMoves);
 }
@@ -290,7 +303,7 @@ TEST_F(MoveGenTest, validKingMovesKingCastle) {
     };
     Board board(boardArr);
     
-    std::vector<BoardMove> validMoves;
+    MoveList moveList;
     std::vector<BoardMove> expectedValidMoves = {
         BoardMove(BoardSquare(7, E), BoardSquare(6, D)),
         BoardMove(BoardSquare(7, E), BoardSquare(6, E)),
@@ -301,9 +314,9 @@ TEST_F(MoveGenTest, validKingMovesKingCastle) {
         BoardMove(BoardSquare(7, E), BoardSquare(7, G)),
     };
     uint64_t whiteKings = arrayToBitboardPieceType(boardArr, WKing);
-    validKingMoves(board, validMoves, whiteKings);
+    validKingMoves(board, LegalityInfo(board), moveList, whiteKings);
 
-    std::sort(validMoves.begin(), validMoves.end());
+    std::vector<BoardMove> validMoves = sortedMoves(board, moveList);
     std::sort(expectedValidMoves.begin(), expectedValidMoves.end());
     ASSERT_EQ(validMoves, expectedValidMoves);    
 }
@@ -321,7 +334,7 @@ TEST_F(MoveGenTest, validKingMovesQueenCastle) {
     };
     Board board(boardArr);
     
-    std::vector<BoardMove> validMoves;
+    MoveList moveList;
     std::vector<BoardMove> expectedValidMoves = {
         BoardMove(BoardSquare(7, E), BoardSquare(6, D)),
         BoardMove(BoardSquare(7, E), BoardSquare(6, E)),
@@ -332,9 +345,9 @@ TEST_F(MoveGenTest, validKingMovesQueenCastle) {
         BoardMove(BoardSquare(7, E), BoardSquare(7, C)),
     };
     uint64_t whiteKings = arrayToBitboardPieceType(boardArr, WKing);
-    validKingMoves(board, validMoves, whiteKings);
+    validKingMoves(board, LegalityInfo(board), moveList, whiteKings);
 
-    std::sort(validMoves.begin(), validMoves.end());
+    std::vector<BoardMove> validMoves = sortedMoves(board, moveList);
     std::sort(expectedValidMoves.begin(), expectedValidMoves.end());
     ASSERT_EQ(validMoves, expectedValidMoves);    
 }
@@ -352,16 +365,16 @@ TEST_F(MoveGenTest, validKingMovesInvalidCastle) {
     };
     Board board(boardArr);
     
-    std::vector<BoardMove> validMoves;
+    MoveList moveList;
     std::vector<BoardMove> expectedValidMoves = {
         BoardMove(BoardSquare(7, E), BoardSquare(6, E)),
         BoardMove(BoardSquare(7, E), BoardSquare(6, F)),
         BoardMove(BoardSquare(7, E), BoardSquare(7, F)),
     };
     uint64_t whiteKings = arrayToBitboardPieceType(boardArr, WKing);
-    validKingMoves(board, validMoves, whiteKings);
+    validKingMoves(board, LegalityInfo(board), moveList, whiteKings);
 
-    std::sort(validMoves.begin(), validMoves.end());
+    std::vector<BoardMove> validMoves = sortedMoves(board, moveList);
     std::sort(expectedValidMoves.begin(), expectedValidMoves.end());
     ASSERT_EQ(validMoves, expectedValidMoves);    
 }
@@ -377,9 +390,9 @@ TEST_F(MoveGenTest, moveGeneratorDefault) {
     expectedValidMoves.push_back(BoardMove(BoardSquare(7, B), BoardSquare(5, C)));
     expectedValidMoves.push_back(BoardMove(BoardSquare(7, G), BoardSquare(5, F)));
     expectedValidMoves.push_back(BoardMove(BoardSquare(7, G), BoardSquare(5, H)));
-    std::vector<BoardMove> validMoves = moveGenerator(board);
+    MoveList moveList = moveGenerator(board);
 
-    std::sort(validMoves.begin(), validMoves.end());
+    std::vector<BoardMove> validMoves = sortedMoves(board, moveList);
     std::sort(expectedValidMoves.begin(), expectedValidMoves.end());
     ASSERT_EQ(board.isWhiteTurn, true);
     ASSERT_EQ(validMoves, expectedValidMoves);
@@ -387,13 +400,13 @@ TEST_F(MoveGenTest, moveGeneratorDefault) {
 
 TEST_F(MoveGenTest, validKingMovesInvalidCastle2) {
     Board board("r2rk3/p4p1p/2p4b/2Q5/1P1Nq3/P1B2P1b/2P4P/R2K3R b q - 0 1");
-    std::vector<BoardMove> moves = moveGenerator(board);
+    MoveList moves = moveGenerator(board);
     EXPECT_EQ(moves.size(), 43);
 }
 
 TEST_F(MoveGenTest, validKingMovesValidCastle3) {
     Board board("r3k3/pp1r1p1p/2B4b/5Q2/1P1Nq3/P1B4b/2P2P1P/R2K3R b q - 2 1");
-    std::vector<BoardMove> moves = moveGenerator(board);
+    MoveList moves = moveGenerator(board);
     EXPECT_EQ(moves.size(), 42);
 }
 
@@ -409,9 +422,9 @@ TEST_F(MoveGenTest, moveGeneratorBlackMove) {
     expectedValidMoves.push_back(BoardMove(BoardSquare(0, B), BoardSquare(2, C)));
     expectedValidMoves.push_back(BoardMove(BoardSquare(0, G), BoardSquare(2, F)));
     expectedValidMoves.push_back(BoardMove(BoardSquare(0, G), BoardSquare(2, H)));
-    std::vector<BoardMove> validMoves = moveGenerator(board);
+    MoveList moveList = moveGenerator(board);
 
-    std::sort(validMoves.begin(), validMoves.end());
+    std::vector<BoardMove> validMoves = sortedMoves(board, moveList);
     std::sort(expectedValidMoves.begin(), expectedValidMoves.end());
     ASSERT_EQ(board.isWhiteTurn, false);
     ASSERT_EQ(validMoves, expectedValidMoves);
@@ -432,4 +445,110 @@ TEST_F(MoveGenTest, perftKiwipete) {
     ASSERT_EQ(MOVEGEN::perft(board, 2), 2039);
     ASSERT_EQ(MOVEGEN::perft(board, 3), 97862);
     ASSERT_EQ(MOVEGEN::perft(board, 4), 4085603);
-}
\ No newline at end of file
+}
+TEST_F(MoveGenTest, perftEnPassantPins) {
+    Board board("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+    ASSERT_EQ(MOVEGEN::perft(board, 1), 14);
+    ASSERT_EQ(MOVEGEN::perft(board, 2), 191);
+    ASSERT_EQ(MOVEGEN::perft(board, 3), 2812);
+    ASSERT_EQ(MOVEGEN::perft(board, 4), 43238);
+    ASSERT_EQ(MOVEGEN::perft(board, 5), 674624);
+}
+
+TEST_F(MoveGenTest, perftPromotionsAndChecks) {
+    Board board("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+    ASSERT_EQ(MOVEGEN::perft(board, 1), 6);
+    ASSERT_EQ(MOVEGEN::perft(board, 2), 264);
+    ASSERT_EQ(MOVEGEN::perft(board, 3), 9467);
+    ASSERT_EQ(MOVEGEN::perft(board, 4), 422333);
+}
+
+TEST_F(MoveGenTest, perftDiscoveredChecks) {
+    Board board("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8");
+    ASSERT_EQ(MOVEGEN::perft(board, 1), 44);
+    ASSERT_EQ(MOVEGEN::perft(board, 2), 1486);
+    ASSERT_EQ(MOVEGEN::perft(board, 3), 62379);
+}
+
+TEST_F(MoveGenTest, noisyAndQuietMovesPartitionAllMoves) {
+    for (std::string fen: {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                           "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+                           "rnbqkb1r/ppp1pppp/5n2/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3"}) {
+        Board board(fen);
+        MOVEGEN::LegalityInfo info(board);
+        MoveList noisyList, quietList;
+        MOVEGEN::generateMoves(board, info, noisyList, MOVEGEN::NoisyMoves);
+        MOVEGEN::generateMoves(board, info, quietList, MOVEGEN::QuietMoves);
+
+        for (const ScoredMove& scoredMove: noisyList) {
+            ASSERT_TRUE(board.moveIsCapture(scoredMove.move) || scoredMove.move.flag() == PromotionMove);
+        }
+        for (const ScoredMove& scoredMove: quietList) {
+            ASSERT_FALSE(board.moveIsCapture(scoredMove.move) || scoredMove.move.flag() == PromotionMove);
+        }
+        std::vector<BoardMove> stagedMoves = sortedMoves(board, noisyList);
+        std::vector<BoardMove> quietMoves = sortedMoves(board, quietList);
+        stagedMoves.insert(stagedMoves.end(), quietMoves.begin(), quietMoves.end());
+        std::sort(stagedMoves.begin(), stagedMoves.end());
+        ASSERT_EQ(stagedMoves, sortedMoves(board, MOVEGEN::moveGenerator(board)));
+    }
+}
+
+TEST_F(MoveGenTest, isLegalMove) {
+    Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    MOVEGEN::LegalityInfo info(board);
+    
+    EXPECT_TRUE(MOVEGEN::isLegalMove(board, info, board.toMove(BoardMove("e1g1", true))));
+    EXPECT_TRUE(MOVEGEN::isLegalMove(board, info, board.toMove(BoardMove("e5f7", true))));
+    EXPECT_FALSE(MOVEGEN::isLegalMove(board, info, Move(BoardSquare("e1").toSquare(), BoardSquare("g1").toSquare()))); // missing castle flag
+    EXPECT_FALSE(MOVEGEN::isLegalMove(board, info, board.toMove(BoardMove("a8b8", true)))); // enemy piece
+    EXPECT_FALSE(MOVEGEN::isLegalMove(board, info, board.toMove(BoardMove("a1a3", true)))); // blocked
+    EXPECT_FALSE(MOVEGEN::isLegalMove(board, info, board.toMove(BoardMove("c3c4", true)))); // not a knight move
+}
+
+TEST_F(MoveGenTest, isLegalMovePinned) {
+    Board board("4k3/4r3/8/8/8/8/4B3/4K3 w - - 0 1");
+    MOVEGEN::LegalityInfo info(board);
+    
+    EXPECT_FALSE(MOVEGEN::isLegalMove(board, info, board.toMove(BoardMove("e2d3", true))));
+    EXPECT_TRUE(MOVEGEN::isLegalMove(board, info, board.toMove(BoardMove("e1d1", true))));
+}
+
+TEST_F(MoveGenTest, captureMovesSkipUnderpromotions) {
+    Board board("1n2k3/P7/8/7p/8/8/8/4K2R w K - 0 1");
+    MOVEGEN::LegalityInfo info(board);
+    MoveList moveList;
+    MOVEGEN::generateMoves(board, info, moveList, MOVEGEN::CaptureMoves);
+    std::vector<BoardMove> validMoves = sortedMoves(board, moveList);
+    std::vector<BoardMove> expectedValidMoves = {
+        BoardMove("a7a8q", true), BoardMove("a7b8q", true), BoardMove("h1h5", true),
+    };
+    std::sort(expectedValidMoves.begin(), expectedValidMoves.end());
+    ASSERT_EQ(validMoves, expectedValidMoves);
+}
+
+// givesCheck is worked out without making the move, so it must agree with the position after it
+TEST_F(MoveGenTest, givesCheckMatchesMakeMove) {
+    std::vector<std::string> fens = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    };
+    for (const std::string& fen: fens) {
+        Board board(fen);
+        for (const ScoredMove& scoredMove: moveGenerator(board)) {
+            bool givesCheck = board.givesCheck(scoredMove.move);
+            board.makeMove(scoredMove.move);
+            EXPECT_EQ(givesCheck, board.isInCheck) << fen << ' ' << scoredMove.move.toStr();
+            // one ply deeper, for the replies
+            for (const ScoredMove& reply: moveGenerator(board)) {
+                bool replyGivesCheck = board.givesCheck(reply.move);
+                board.makeMove(reply.move);
+                EXPECT_EQ(replyGivesCheck, board.isInCheck) << fen << ' ' << scoredMove.move.toStr() << ' ' << reply.move.toStr();
+                board.undoMove();
+            }
+            board.undoMove();
+        }
+    }
+}
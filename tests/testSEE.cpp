@@ -0,0 +1,56 @@
+#include "board.hpp"
+#include "see.hpp"
+#include "attacks.hpp"
+#include "zobrist.hpp"
+
+#include <gtest/gtest.h>
+
+class SEETest : public testing::Test {
+    public:
+        static void SetUpTestSuite() {
+            Zobrist::init();
+            Attacks::init();
+        }
+};
+
+TEST_F(SEETest, undefendedCapture) {
+    Board board("4k3/8/8/3p4/8/8/8/3RK3 w - - 0 1");
+    ASSERT_EQ(SEE::evaluate(board, board.toMove(BoardMove("d1d5", true))), 100);
+}
+
+TEST_F(SEETest, queenTakesDefendedPawn) {
+    Board board("4k3/8/4p3/3p4/8/8/8/3QK3 w - - 0 1");
+    ASSERT_EQ(SEE::evaluate(board, board.toMove(BoardMove("d1d5", true))), 100 - 900);
+}
+
+TEST_F(SEETest, pawnTakesDefendedKnight) {
+    Board board("4k3/8/4p3/3n4/4P3/8/8/4K3 w - - 0 1");
+    ASSERT_EQ(SEE::evaluate(board, board.toMove(BoardMove("e4d5", true))), 300 - 100);
+}
+
+TEST_F(SEETest, xRayRookBehindRook) {
+    // the second rook only attacks d5 once the first rook has captured
+    Board board("3rk3/3r4/8/3p4/8/8/3R4/3RK3 w - - 0 1");
+    ASSERT_EQ(SEE::evaluate(board, board.toMove(BoardMove("d2d5", true))), 100 - 500 + 500 - 500);
+}
+
+TEST_F(SEETest, xRayQueenBehindBishop) {
+    // the queen recaptures through the square the bishop left
+    Board board("4k3/8/8/4p3/3p4/8/1B6/Q3K3 w - - 0 1");
+    ASSERT_EQ(SEE::evaluate(board, board.toMove(BoardMove("b2d4", true))), 100 - 300 + 100);
+}
+
+TEST_F(SEETest, kingCantRecaptureDefendedPiece) {
+    Board board("4k3/8/8/8/8/8/3q4/3RK3 b - - 0 1");
+    ASSERT_EQ(SEE::evaluate(board, board.toMove(BoardMove("d2d1", false))), 500 - 900);
+}
+
+TEST_F(SEETest, quietMoveToAttackedSquare) {
+    Board board("4k3/8/8/2p5/8/3N4/8/4K3 w - - 0 1");
+    ASSERT_EQ(SEE::evaluate(board, board.toMove(BoardMove("d3b4", true))), -300);
+}
+
+TEST_F(SEETest, enPassant) {
+    Board board("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1");
+    ASSERT_EQ(SEE::evaluate(board, board.toMove(BoardMove("e5d6", true))), 100);
+}
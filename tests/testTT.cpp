@@ -0,0 +1,116 @@
+#include "tt.hpp"
+#include "move.hpp"
+#include "search.hpp"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+
+// 1 MB holds 2^14 buckets, so keys that only differ in their lower 50 bits share a bucket
+static uint64_t bucketKey(uint64_t bucket, uint64_t index) {
+    return bucket << 50 | (index + 1);
+}
+
+TEST(TTTest, storeProbeRoundTrip) {
+    TT::Table table(1);
+    TT::Entry entry;
+    EXPECT_FALSE(table.probe(bucketKey(3, 0), entry));
+
+    Move move(12, 28);
+    table.store(bucketKey(3, 0), 7, -250, TT::LowerBound, move);
+    ASSERT_TRUE(table.probe(bucketKey(3, 0), entry));
+    EXPECT_EQ(entry.depth, 7);
+    EXPECT_EQ(entry.score, -250);
+    EXPECT_EQ(entry.bound(), TT::LowerBound);
+    EXPECT_EQ(entry.getMove(), move);
+    EXPECT_FALSE(table.probe(bucketKey(3, 1), entry));
+}
+
+TEST(TTTest, sameKeyReplacement) {
+    TT::Table table(1);
+    TT::Entry entry;
+    uint64_t key = bucketKey(5, 0);
+    table.store(key, 10, 30, TT::ExactBound, Move(12, 28));
+
+    // a much shallower bound from the same search keeps the deep entry, but takes the newer move
+    table.store(key, 0, 500, TT::UpperBound, Move(11, 27));
+    ASSERT_TRUE(table.probe(key, entry));
+    EXPECT_EQ(entry.depth, 10);
+    EXPECT_EQ(entry.score, 30);
+    EXPECT_EQ(entry.bound(), TT::ExactBound);
+    EXPECT_EQ(entry.getMove(), Move(11, 27));
+
+    // without a move the old one is kept
+    table.store(key, 9, 40, TT::LowerBound, Move());
+    ASSERT_TRUE(table.probe(key, entry));
+    EXPECT_EQ(entry.depth, 9);
+    EXPECT_EQ(entry.score, 40);
+    EXPECT_EQ(entry.getMove(), Move(11, 27));
+
+    // exact scores always replace
+    table.store(key, 1, 50, TT::ExactBound, Move(12, 20));
+    ASSERT_TRUE(table.probe(key, entry));
+    EXPECT_EQ(entry.depth, 1);
+    EXPECT_EQ(entry.score, 50);
+
+    // so does anything from a later search
+    table.store(key, 12, 60, TT::ExactBound, Move(12, 20));
+    table.newSearch();
+    table.store(key, 0, 70, TT::UpperBound, Move());
+    ASSERT_TRUE(table.probe(key, entry));
+    EXPECT_EQ(entry.depth, 0);
+    EXPECT_EQ(entry.score, 70);
+}
+
+TEST(TTTest, shallowestEntryEvicted) {
+    TT::Table table(1);
+    TT::Entry entry;
+    int depths[TT::BUCKET_SIZE] = {20, 10, 30, 40};
+    for (int i = 0; i < TT::BUCKET_SIZE; i++) {
+        table.store(bucketKey(7, i), depths[i], 0, TT::ExactBound, Move());
+    }
+    table.store(bucketKey(7, TT::BUCKET_SIZE), 5, 0, TT::ExactBound, Move());
+    EXPECT_TRUE(table.probe(bucketKey(7, TT::BUCKET_SIZE), entry));
+    EXPECT_FALSE(table.probe(bucketKey(7, 1), entry));
+    for (int i: {0, 2, 3}) {
+        EXPECT_TRUE(table.probe(bucketKey(7, i), entry));
+    }
+}
+
+TEST(TTTest, oldEntriesEvicted) {
+    TT::Table table(1);
+    TT::Entry entry;
+    for (int i = 0; i < TT::BUCKET_SIZE; i++) {
+        table.store(bucketKey(9, i), 20, 0, TT::ExactBound, Move());
+    }
+    // three searches later the deep entries are worth less than a new shallow one
+    for (int i = 0; i < 3; i++) {
+        table.newSearch();
+    }
+    table.store(bucketKey(9, TT::BUCKET_SIZE), 5, 0, TT::ExactBound, Move());
+    table.store(bucketKey(9, TT::BUCKET_SIZE + 1), 5, 0, TT::ExactBound, Move());
+    EXPECT_TRUE(table.probe(bucketKey(9, TT::BUCKET_SIZE), entry));
+    EXPECT_TRUE(table.probe(bucketKey(9, TT::BUCKET_SIZE + 1), entry));
+    int oldKept = 0;
+    for (int i = 0; i < TT::BUCKET_SIZE; i++) {
+        oldKept += table.probe(bucketKey(9, i), entry);
+    }
+    EXPECT_EQ(oldKept, TT::BUCKET_SIZE - 2);
+}
+
+// mate scores are stored as distance from the node, and read back as distance from the root of the probing search
+TEST(TTTest, mateScoreNormalization) {
+    int mateFromRoot = Search::mateIn(7);
+    int stored = Search::scoreToTT(mateFromRoot, 4);
+    EXPECT_EQ(stored, Search::mateIn(3));
+    EXPECT_EQ(Search::scoreFromTT(stored, 4), mateFromRoot);
+    EXPECT_EQ(Search::scoreFromTT(stored, 2), Search::mateIn(5));
+
+    int matedFromRoot = Search::matedIn(6);
+    stored = Search::scoreToTT(matedFromRoot, 5);
+    EXPECT_EQ(stored, Search::matedIn(1));
+    EXPECT_EQ(Search::scoreFromTT(stored, 8), Search::matedIn(9));
+
+    // other scores don't depend on the ply
+    EXPECT_EQ(Search::scoreToTT(123, 10), 123);
+    EXPECT_EQ(Search::scoreFromTT(-45, 10), -45);
+}
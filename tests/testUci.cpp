@@ -0,0 +1,13 @@
+#include "uci.hpp"
+
+#include <gtest/gtest.h>
+
+// while go infinite or go ponder runs, the loop must keep reading until stop arrives
+TEST(UciTest, onlyStateCommandsWaitForSearch) {
+    for (const char* command: {"ucinewgame", "setoption", "position", "go", "perft", "perftbench", "bench"}) {
+        EXPECT_TRUE(Uci::waitsForSearch(command)) << command;
+    }
+    for (const char* command: {"", "debug", "register", "foo", "isready", "stop", "ponderhit"}) {
+        EXPECT_FALSE(Uci::waitsForSearch(command)) << command;
+    }
+}